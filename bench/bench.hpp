@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// runs `f` `iterations` times and prints the average time per run.
+template <typename Func>
+double measure(const std::string& name, size_t iterations, Func f) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() /
+                static_cast<double>(iterations);
+
+    std::cout << name << ": " << ms << " ms\n";
+
+    return ms;
+}
+
+// keeps the compiler from optimizing away the result of a benchmark.
+template <typename T>
+void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,46 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/node.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// parses the metadata of a large page with the whole document and with
+// parsing stopped after the head.
+int main() {
+    std::string html(
+        "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+        "<title>Large page</title>"
+        "<link rel=\"canonical\" href=\"https://example.com/page\">"
+        "<base href=\"https://example.com/\"></head><body>");
+    for (size_t i = 0; i < 50000; ++i) {
+        html += R"(<div class="row"><p>Some text <a href="/x">link</a></p>)";
+        html += "</div>";
+    }
+    html += "</body></html>";
+
+    std::cout << "page (" << html.size() << " bytes)\n";
+
+    measure("  parse", 10, [&] {
+        auto tree = myhtmlpp::parse(html);
+        do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::TITLE).size());
+    });
+
+    myhtmlpp::ParseOptions head;
+    head.stop = myhtmlpp::STOP::AFTER_HEAD;
+    measure("  parse until </head>", 10, [&] {
+        auto tree = myhtmlpp::parse(html, head);
+        do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::TITLE).size());
+    });
+
+    myhtmlpp::ParseOptions prefix;
+    prefix.stop_after_bytes = 1024;
+    measure("  parse 1 KiB", 10, [&] {
+        auto tree = myhtmlpp::parse(html, prefix);
+        do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::TITLE).size());
+    });
+}
@@ -0,0 +1,52 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// parses many small documents with a new myhtml instance per document,
+// with pooled instances and with parse_async on the shared thread pool.
+int main() {
+    const std::string html(
+        "<!DOCTYPE html><html><head><title>Item</title></head><body>"
+        "<div class=\"item\"><p>Some text <a href=\"/x\">link</a></p></div>"
+        "</body></html>");
+    const size_t documents = 2000;
+
+    std::cout << documents << " documents (" << html.size()
+              << " bytes each)\n";
+
+    measure("  parse", 10, [&] {
+        for (size_t i = 0; i < documents; ++i) {
+            auto tree = myhtmlpp::parse(html);
+            do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::A).size());
+        }
+    });
+
+    myhtmlpp::ParseOptions reused;
+    reused.reuse_engine = true;
+    measure("  parse with reuse_engine", 10, [&] {
+        for (size_t i = 0; i < documents; ++i) {
+            auto tree = myhtmlpp::parse(html, reused);
+            do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::A).size());
+        }
+    });
+
+    measure("  parse_async", 10, [&] {
+        std::vector<std::future<myhtmlpp::Tree>> futures;
+        futures.reserve(documents);
+        for (size_t i = 0; i < documents; ++i) {
+            futures.push_back(myhtmlpp::parse_async(html));
+        }
+        for (auto& future : futures) {
+            auto tree = future.get();
+            do_not_optimize(tree.find_by_tag(myhtmlpp::TAG::A).size());
+        }
+    });
+}
@@ -0,0 +1,88 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/node.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/text.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// probes a page for literals by building the inner text of every block
+// element vs. searching the text nodes and a text arena.
+int main() {
+    std::string html = "<html><body>";
+    for (size_t i = 0; i < 5000; ++i) {
+        html += "<div><p>Lorem ipsum dolor sit amet, <b>consectetur</b> "
+                "adipiscing elit, sed do eiusmod tempor incididunt.</p>"
+                "<p>Ut enim ad minim veniam, quis nostrud exercitation "
+                "ullamco laboris.</p></div>";
+    }
+    html += "<p>special offer</p></body></html>";
+
+    auto tree = myhtmlpp::parse(html);
+    std::vector<std::string> probes{"special offer", "exercitation",
+                                    "not on the page", "sed do"};
+
+    size_t hits = 0;
+    measure("inner_text + find", 5, [&] {
+        hits = 0;
+        for (const auto& probe : probes) {
+            for (const auto& p : tree.find_by_tag(myhtmlpp::TAG::P)) {
+                if (p.inner_text().find(probe) != std::string::npos) {
+                    ++hits;
+                }
+            }
+        }
+        do_not_optimize(hits);
+    });
+    std::cout << "  hits: " << hits << "\n";
+
+    measure("find_text (text nodes)", 5, [&] {
+        hits = 0;
+        for (const auto& probe : probes) {
+            hits += tree.find_text(probe).size();
+        }
+        do_not_optimize(hits);
+    });
+    std::cout << "  hits: " << hits << "\n";
+
+    measure("find_text (elements)", 5, [&] {
+        hits = 0;
+        for (const auto& probe : probes) {
+            hits += tree.find_text(probe, myhtmlpp::TEXT_SEARCH::ELEMENTS)
+                        .size();
+        }
+        do_not_optimize(hits);
+    });
+    std::cout << "  hits: " << hits << "\n";
+
+    // element search for several probes over one arena copy
+    measure("text_arena + find_elements", 5, [&] {
+        hits = 0;
+        auto arena = tree.text_arena();
+        for (const auto& probe : probes) {
+            hits += arena.find_elements(probe).size();
+        }
+        do_not_optimize(hits);
+    });
+    std::cout << "  hits: " << hits << "\n";
+
+    // several probes over one arena copy
+    measure("text_arena + find_substring", 5, [&] {
+        hits = 0;
+        auto arena = tree.text_arena();
+        for (const auto& probe : probes) {
+            for (size_t pos = myhtmlpp::find_substring(arena.text(), probe);
+                 pos != std::string::npos;
+                 pos = myhtmlpp::find_substring(arena.text(), probe, pos + 1)) {
+                ++hits;
+            }
+        }
+        do_not_optimize(hits);
+    });
+    std::cout << "  hits: " << hits << "\n";
+}
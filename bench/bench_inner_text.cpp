@@ -0,0 +1,72 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/node.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// the former recursive implementation of Node::inner_text.
+std::string recursive_inner_text(const myhtmlpp::Node& node) {
+    std::string res;
+
+    if (node.tag_id() == myhtmlpp::TAG::TEXT_) {
+        res += node.text();
+    }
+
+    for (const auto& ch : node.children()) {
+        res += recursive_inner_text(ch);
+    }
+
+    return res;
+}
+
+void run(const std::string& name, const std::string& html) {
+    auto tree = myhtmlpp::parse(html);
+    auto body = tree.body_node();
+
+    std::cout << name << " (" << body.inner_text_length() << " chars)\n";
+
+    measure("  recursive", 10, [&] {
+        auto text = recursive_inner_text(body);
+        do_not_optimize(text.size());
+    });
+
+    measure("  inner_text", 10, [&] {
+        auto text = body.inner_text();
+        do_not_optimize(text.size());
+    });
+
+    std::string buffer;
+    measure("  inner_text_into (reused buffer)", 10, [&] {
+        buffer.clear();
+        body.inner_text_into(buffer);
+        do_not_optimize(buffer.size());
+    });
+}
+
+}  // namespace
+
+// extracts the text of a deeply nested and of a wide document with the
+// former recursive implementation and the iterative one.
+int main() {
+    std::string deep = "<html><body>";
+    for (size_t i = 0; i < 2000; ++i) {
+        deep += "<span>text ";
+    }
+    deep += "</body></html>";
+
+    std::string wide = "<html><body>";
+    for (size_t i = 0; i < 20000; ++i) {
+        wide += R"(<div><p>some text <b>bold</b></p><p>more text</p></div>)";
+    }
+    wide += "</body></html>";
+
+    run("deep", deep);
+    run("wide", wide);
+}
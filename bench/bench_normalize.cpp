@@ -0,0 +1,80 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/text.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+// scalar reference: collapses and trims whitespace and no-break spaces one
+// character at a time.
+void reference_normalize(std::string& out, std::string_view text) {
+    bool skip = true;
+    size_t base = out.size();
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        bool space = is_space(text[i]);
+        if (text[i] == '\xC2' && i + 1 < text.size() && text[i + 1] == '\xA0') {
+            space = true;
+            ++i;
+        }
+
+        if (!space) {
+            out += text[i];
+            skip = false;
+        } else if (!skip) {
+            out += ' ';
+            skip = true;
+        }
+    }
+
+    while (out.size() > base && out.back() == ' ') {
+        out.pop_back();
+    }
+}
+
+void run(const std::string& name, const std::string& text) {
+    std::cout << name << " (" << text.size() << " bytes)\n";
+
+    std::string out;
+    out.reserve(text.size());
+
+    measure("  scalar reference", 50, [&] {
+        out.clear();
+        reference_normalize(out, text);
+        do_not_optimize(out.size());
+    });
+    std::string expected = out;
+
+    measure("  append_normalized", 50, [&] {
+        out.clear();
+        myhtmlpp::append_normalized(out, text);
+        do_not_optimize(out.size());
+    });
+
+    if (out != expected) {
+        std::cout << "  results differ\n";
+    }
+}
+
+}  // namespace
+
+// normalizes prose with single spaces and heavily indented markup text.
+int main() {
+    std::string prose;
+    std::string indented;
+    for (size_t i = 0; i < 100000; ++i) {
+        prose += "The quick brown fox jumps over the lazy dog.\xC2\xA0";
+        indented += "\n                paragraph\t\t";
+    }
+
+    run("prose", prose);
+    run("indented", indented);
+}
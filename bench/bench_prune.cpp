@@ -0,0 +1,128 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/node.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <myhtml/tree.h>
+#include <string>
+
+namespace {
+
+void report(const std::string& name, const myhtmlpp::Tree& tree) {
+    size_t nodes = 0;
+    size_t text_bytes = 0;
+    for (const auto& node : tree) {
+        ++nodes;
+        if (node.tag_id() == myhtmlpp::TAG::TEXT_ ||
+            node.tag_id() == myhtmlpp::TAG::COMMENT_) {
+            text_bytes += node.text_view().size();
+        }
+    }
+
+    std::cout << "  " << name << ": " << nodes << " nodes ("
+              << nodes * sizeof(myhtml_tree_node_t) / 1024 << " KiB), "
+              << text_bytes << " bytes of text and comments\n";
+}
+
+void run(const std::string& name, const std::string& html,
+         const myhtmlpp::ParseOptions& options) {
+    std::cout << name << " (" << html.size() << " bytes)\n";
+
+    auto tree = myhtmlpp::parse(html);
+    auto pruned = myhtmlpp::parse(html, options);
+    report("default", tree);
+    report("pruned", pruned);
+
+    measure("  parse", 10, [&] {
+        auto parsed = myhtmlpp::parse(html);
+        do_not_optimize(parsed.html_node());
+    });
+
+    measure("  parse pruned", 10, [&] {
+        auto parsed = myhtmlpp::parse(html, options);
+        do_not_optimize(parsed.html_node());
+    });
+
+    measure("  traverse", 10, [&] {
+        size_t count = 0;
+        for (const auto& node : tree) {
+            count += node.tag_id() == myhtmlpp::TAG::A ? 1 : 0;
+        }
+        do_not_optimize(count);
+    });
+
+    measure("  traverse pruned", 10, [&] {
+        size_t count = 0;
+        for (const auto& node : pruned) {
+            count += node.tag_id() == myhtmlpp::TAG::A ? 1 : 0;
+        }
+        do_not_optimize(count);
+    });
+
+    measure("  inner_text", 10, [&] {
+        do_not_optimize(tree.body_node().inner_text_length());
+    });
+
+    measure("  inner_text pruned", 10, [&] {
+        do_not_optimize(pruned.body_node().inner_text_length());
+    });
+}
+
+}  // namespace
+
+// parses a page with the inline scripts, styles and comments of a typical
+// bundled site and a pretty-printed page with and without dropping them
+// at tree construction.
+int main() {
+    std::string script(
+        "<script>!function(e){var t={};function n(r){if(t[r])return "
+        "t[r].exports;var o=t[r]={i:r,l:!1,exports:{}};return e[r].call("
+        "o.exports,o,o.exports,n),o.l=!0,o.exports}n.m=e,n.c=t}([]);"
+        "</script>\n");
+    std::string style(
+        "<style>.card{display:flex;margin:0 auto;padding:8px 16px}"
+        ".card__title{font:600 1.25rem/1.4 system-ui,sans-serif}</style>\n");
+
+    std::string bundled = "<html><head>";
+    for (size_t i = 0; i < 50; ++i) {
+        bundled += style;
+        bundled += script;
+    }
+    bundled += "</head><body>";
+    for (size_t i = 0; i < 5000; ++i) {
+        bundled += "<!-- card " + std::to_string(i) + " -->";
+        bundled += R"(<div class="card"><h2 class="card__title">Title</h2>)";
+        bundled += R"(<p>Some text <a href="/more">more</a></p></div>)";
+        if (i % 10 == 0) {
+            bundled += script;
+        }
+    }
+    bundled += "</body></html>";
+
+    std::string pretty = "<html>\n  <head>\n  </head>\n  <body>\n";
+    for (size_t i = 0; i < 5000; ++i) {
+        pretty += "    <div class=\"card\">\n"
+                  "      <h2>Title</h2>\n"
+                  "      <ul>\n"
+                  "        <li><a href=\"/a\">a</a></li>\n"
+                  "        <li><a href=\"/b\">b</a></li>\n"
+                  "      </ul>\n"
+                  "    </div>\n";
+    }
+    pretty += "  </body>\n</html>\n";
+
+    myhtmlpp::ParseOptions drop_code;
+    drop_code.drop_comments = true;
+    drop_code.drop_script_text = true;
+    drop_code.drop_style_text = true;
+
+    myhtmlpp::ParseOptions drop_whitespace;
+    drop_whitespace.drop_whitespace_text = true;
+
+    run("bundled page, comments, scripts and styles", bundled, drop_code);
+    run("pretty-printed page, whitespace", pretty, drop_whitespace);
+}
@@ -0,0 +1,50 @@
+#include "bench.hpp"
+
+#include <myhtmlpp/constants.hpp>
+#include <myhtmlpp/parser.hpp>
+#include <myhtmlpp/snapshot.hpp>
+#include <myhtmlpp/tree.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// counts all <a> tags by walking the myhtml nodes vs. sweeping the tag column
+// of a Snapshot.
+int main() {
+    std::string html = "<html><body>";
+    for (size_t i = 0; i < 20000; ++i) {
+        html += R"(<div class="item"><p>text <a href="/link">link</a></p>)"
+                R"(<ul><li>one</li><li><span>two</span></li></ul></div>)";
+    }
+    html += "</body></html>";
+
+    auto tree = myhtmlpp::parse(html);
+
+    size_t count = 0;
+    measure("pointer walk", 20, [&] {
+        count = 0;
+        for (const auto& node : tree) {
+            count += node.tag_id() == myhtmlpp::TAG::A ? 1 : 0;
+        }
+        do_not_optimize(count);
+    });
+    std::cout << "  a tags: " << count << "\n";
+
+    measure("find_by_tag", 20, [&] {
+        count = tree.find_by_tag(myhtmlpp::TAG::A).size();
+        do_not_optimize(count);
+    });
+
+    measure("snapshot build", 20, [&] {
+        auto snapshot = tree.snapshot();
+        do_not_optimize(snapshot.size());
+    });
+
+    auto snapshot = tree.snapshot();
+    measure("snapshot count", 20, [&] {
+        count = snapshot.count(myhtmlpp::TAG::A);
+        do_not_optimize(count);
+    });
+    std::cout << "  a tags: " << count << "\n";
+}
@@ -5,6 +5,7 @@
 #include <myhtml/myhtml.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
@@ -67,6 +68,22 @@ public:
      */
     [[nodiscard]] std::string value() const;
 
+    /**
+     * @brief Get the key of the attribute without copying it.
+     *
+     * @return A view of the attribute key stored in the tree, valid as long
+     *         as the Tree is alive.
+     */
+    [[nodiscard]] std::string_view key_view() const;
+
+    /**
+     * @brief Get the value of the attribute without copying it.
+     *
+     * @return A view of the attribute value stored in the tree, valid as
+     *         long as the Tree is alive.
+     */
+    [[nodiscard]] std::string_view value_view() const;
+
     /**
      * @brief Get the namespace of the attribute.
      *
@@ -93,16 +110,20 @@ public:
 
     // structured bindings support
     // auto [key, value] = attr;
+    // key and value are std::string_views into the tree.
     template <std::size_t N>
     decltype(auto) get() const {
         if constexpr (N == 0) {
-            return key();
+            return key_view();
         } else if constexpr (N == 1) {
-            return value();
+            return value_view();
         }
     }
 
 private:
+    /// Gives the library internals access to the myhtml pointer.
+    friend struct RawAccess;
+
     /// Pointer to the underlying myhtml attribute struct.
     myhtml_tree_attr_t* m_raw_attribute;
 };
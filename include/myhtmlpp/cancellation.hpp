@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+namespace myhtmlpp {
+
+/**
+ * @brief A deadline and a flag that bound the time of parsing and long
+ *        queries.
+ *
+ * A token is cancelled when its deadline has passed or `cancel()` was
+ * called on it or on one of its copies, which may happen on another
+ * thread. Operations that accept a token check it every few hundred nodes
+ * (or between the chunks of a parse) and throw cancelled_error once it is
+ * cancelled.
+ */
+class CancellationToken {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Creates a token without a deadline, which is only cancelled
+     *        by `cancel()`.
+     */
+    CancellationToken();
+
+    /**
+     * @brief Creates a token that is cancelled at `deadline`.
+     */
+    explicit CancellationToken(clock::time_point deadline);
+
+    /**
+     * @brief Creates a token that is cancelled `timeout` from now.
+     */
+    [[nodiscard]] static CancellationToken after(clock::duration timeout);
+
+    /**
+     * @brief Cancels the token and all of its copies.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks if `cancel()` was called or the deadline has passed.
+     */
+    [[nodiscard]] bool cancelled() const;
+
+    /**
+     * @brief Returns the deadline, std::nullopt if the token has none.
+     */
+    [[nodiscard]] std::optional<clock::time_point> deadline() const;
+
+    /**
+     * @brief Throws if the token is cancelled.
+     *
+     * @throw cancelled_error if `cancelled()` returns true.
+     */
+    void check() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    std::optional<clock::time_point> m_deadline;
+};
+
+}  // namespace myhtmlpp
@@ -279,4 +279,110 @@ enum class OPTION : unsigned int {
     PARSE_MODE_SEPARATELY = 0x04
 };
 
+/// The character encoding of an input, the values are those of myencoding.
+enum class ENCODING : unsigned int {
+    /// Detect the encoding from a byte order mark or a `<meta charset>`,
+    /// see detect_encoding.
+    AUTO = 0x01,
+    UTF_8 = 0x00,
+    UTF_16LE = 0x04,
+    UTF_16BE = 0x05,
+    X_USER_DEFINED = 0x06,
+    BIG5 = 0x07,
+    EUC_JP = 0x08,
+    EUC_KR = 0x09,
+    GB18030 = 0x0a,
+    GBK = 0x0b,
+    IBM866 = 0x0c,
+    ISO_2022_JP = 0x0d,
+    ISO_8859_10 = 0x0e,
+    ISO_8859_13 = 0x0f,
+    ISO_8859_14 = 0x10,
+    ISO_8859_15 = 0x11,
+    ISO_8859_16 = 0x12,
+    ISO_8859_2 = 0x13,
+    ISO_8859_3 = 0x14,
+    ISO_8859_4 = 0x15,
+    ISO_8859_5 = 0x16,
+    ISO_8859_6 = 0x17,
+    ISO_8859_7 = 0x18,
+    ISO_8859_8 = 0x19,
+    ISO_8859_8_I = 0x1a,
+    KOI8_R = 0x1b,
+    KOI8_U = 0x1c,
+    MACINTOSH = 0x1d,
+    SHIFT_JIS = 0x1e,
+    WINDOWS_1250 = 0x1f,
+    WINDOWS_1251 = 0x20,
+    WINDOWS_1252 = 0x21,
+    WINDOWS_1253 = 0x22,
+    WINDOWS_1254 = 0x23,
+    WINDOWS_1255 = 0x24,
+    WINDOWS_1256 = 0x25,
+    WINDOWS_1257 = 0x26,
+    WINDOWS_1258 = 0x27,
+    WINDOWS_874 = 0x28,
+    X_MAC_CYRILLIC = 0x29,
+    LAST_ENTRY = 0x2a
+};
+
+/// Position of a node relative to another node, see Node::document_position.
+enum class DOCUMENT_POSITION : unsigned int {
+    EQUAL = 0x00,
+    DISCONNECTED = 0x01,
+    PRECEDING = 0x02,
+    FOLLOWING = 0x04,
+    CONTAINS = 0x08,
+    CONTAINED_BY = 0x10
+};
+
+/// A resource limit of a parse, see ParseLimits.
+enum class LIMIT : unsigned int {
+    INPUT_SIZE = 0x00,
+    DEPTH = 0x01,
+    NODES = 0x02,
+    ATTRIBUTES = 0x03,
+    TREE_MEMORY = 0x04
+};
+
+/// Where parsing stops before the end of the input.
+enum class STOP : unsigned int {
+    /// Parse the whole input.
+    NEVER = 0x00,
+    /// Stop when the head is complete, at `</head>` or at the first
+    /// content that belongs into the body.
+    AFTER_HEAD = 0x01,
+    /// Stop when the body element is inserted, with the attributes of the
+    /// `<body>` start tag if there is one.
+    AFTER_BODY_START = 0x02
+};
+
+/// How an attribute condition compares the attribute value.
+enum class ATTRIBUTE_MATCH : unsigned int {
+    /// `[key]`
+    EXISTS = 0x00,
+    /// `[key=value]`
+    EQUAL = 0x01,
+    /// `[key~=value]`, one of the whitespace separated words
+    INCLUDE = 0x02,
+    /// `[key|=value]`, equal or followed by `-`
+    DASH = 0x03,
+    /// `[key^=value]`
+    PREFIX = 0x04,
+    /// `[key$=value]`
+    SUFFIX = 0x05,
+    /// `[key*=value]`
+    SUBSTRING = 0x06
+};
+
+/// What Tree::find_text returns.
+enum class TEXT_SEARCH : unsigned int {
+    /// The text nodes whose text contains the needle.
+    TEXT_NODES = 0x00,
+
+    /// The deepest elements whose inner text contains the needle, also
+    /// where it spans several text nodes, e.g. `<p>fo<b>o</b></p>`.
+    ELEMENTS = 0x01
+};
+
 }  // namespace myhtmlpp
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "constants.hpp"
+
 #include <exception>
 #include <mycore/myosi.h>
 #include <stdexcept>
+#include <string_view>
 
 namespace myhtmlpp {
 
@@ -39,4 +42,48 @@ public:
     explicit parse_error(mystatus_t status);
 };
 
+/// The status code of limit_exceeded. The status codes of the library are
+/// outside of the ranges of the status codes of myhtml, mycss and modest.
+inline constexpr mystatus_t limit_exceeded_status = 0xff000001;
+
+/// Exception indicating that a document exceeded a limit of ParseLimits.
+class limit_exceeded : public myhtml_error {
+public:
+    explicit limit_exceeded(LIMIT limit);
+
+    /**
+     * @brief Returns the limit that was exceeded.
+     */
+    [[nodiscard]] LIMIT limit() const;
+
+private:
+    LIMIT m_limit;
+};
+
+/// The status code of cancelled_error.
+inline constexpr mystatus_t cancelled_status = 0xff000002;
+
+/// Exception indicating that a CancellationToken was cancelled or its
+/// deadline passed before an operation completed.
+class cancelled_error : public myhtml_error {
+public:
+    cancelled_error();
+};
+
+/// Exception indicating that `myhtml_serialization_tree_callback` or
+/// `myhtml_serialization_node_callback` failed.
+class serialization_error : public myhtml_error {
+public:
+    explicit serialization_error(mystatus_t status);
+};
+
+/// The status code of a selector that mycss parsed with errors.
+inline constexpr mystatus_t invalid_selector_status = 0xff000003;
+
+/// Exception indicating that mycss could not parse a selector.
+class selector_error : public myhtml_error {
+public:
+    selector_error(mystatus_t status, std::string_view selector);
+};
+
 }  // namespace myhtmlpp
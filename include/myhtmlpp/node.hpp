@@ -2,16 +2,40 @@
 
 #include "attribute.hpp"
 #include "constants.hpp"
+#include "serialization.hpp"
+#include "text.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <myhtml/myhtml.h>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace myhtmlpp {
 
+/// A byte range `[begin, end)` in the source a Tree was parsed from.
+struct SourceRange {
+    size_t begin = 0;
+    size_t end = 0;
+
+    /**
+     * @brief Returns the number of bytes in the range.
+     */
+    [[nodiscard]] size_t size() const { return end - begin; }
+
+    [[nodiscard]] bool operator==(const SourceRange& other) const {
+        return begin == other.begin && end == other.end;
+    }
+
+    [[nodiscard]] bool operator!=(const SourceRange& other) const {
+        return !operator==(other);
+    }
+};
+
 /// A HTML Node class.
 class Node {
 public:
@@ -57,6 +81,16 @@ public:
      */
     [[nodiscard]] std::string operator[](const std::string& key) const noexcept;
 
+    /**
+     * Returns the value of the attribute with key `key` without copying it.
+     *
+     * @param key The key of the attribute to access.
+     * @return A view of the value of the Attribute with the key `key` if it
+     *         exists, an empty view otherwise. The view is valid as long as
+     *         the Tree is alive.
+     */
+    [[nodiscard]] std::string_view value_view(std::string_view key) const;
+
     /**
      * @brief Check if myhtml pointer is not nullptr.
      *
@@ -79,6 +113,79 @@ public:
      */
     [[nodiscard]] std::string html_deep() const;
 
+    /**
+     * @brief Writes a HTML representation of the node to `sink`.
+     *
+     * The HTML is passed to `sink` in chunks as myhtml produces it, without
+     * collecting it in a buffer first.
+     *
+     * @throw serialization_error if myhtml fails to serialize the node.
+     * @see Node::html
+     */
+    void write_html(const Sink& sink) const;
+
+    /**
+     * @brief Writes a HTML representation of the tree starting at the node
+     *        to `sink`.
+     *
+     * @throw serialization_error if myhtml fails to serialize the tree.
+     * @see Node::html_deep
+     */
+    void write_html_deep(const Sink& sink) const;
+
+    /**
+     * @brief Returns a HTML representation of the tree starting at the node,
+     *        serialized with `options`.
+     *
+     * @see SerializeOptions
+     */
+    [[nodiscard]] std::string
+    html_deep(const SerializeOptions& options) const;
+
+    /**
+     * @brief Writes a HTML representation of the tree starting at the node,
+     *        serialized with `options`, to `sink`.
+     *
+     * The output is written in chunks of at most a few KiB.
+     *
+     * @throw serialization_error if myhtml fails to serialize the tree.
+     * @see SerializeOptions
+     */
+    void write_html_deep(const Sink& sink,
+                         const SerializeOptions& options) const;
+
+    /**
+     * @brief Returns the byte range of the node in the source the Tree was
+     *        parsed from.
+     *
+     * The range of an element spans from its start tag to its end tag, or
+     * to the end of its last descendant if the end tag is omitted. The
+     * range of the document node is the whole source. Nodes the parser
+     * implied without a start tag begin with their first descendant.
+     *
+     * The offsets come from the positions myhtml records for every token,
+     * nothing is serialized. Elements the parser moved or duplicated, e.g.
+     * when repairing misnested formatting elements, keep the range of the
+     * tag they were created from.
+     *
+     * @return Optional with the range, std::nullopt if the node has no
+     *         position in the source, e.g. because it was created after
+     *         parsing.
+     */
+    [[nodiscard]] std::optional<SourceRange> source_range() const;
+
+    /**
+     * @brief Returns the original markup of the node and its descendants.
+     *
+     * A slice of Tree::source, so the markup is returned byte for byte as it
+     * was parsed, without serializing the subtree.
+     *
+     * @return A view of the source in source_range(), an empty view if the
+     *         node has no position or the source is not available. The view
+     *         is valid as long as Tree::source is.
+     */
+    [[nodiscard]] std::string_view raw_html() const;
+
     /**
      * @brief Returns a string of the text in the node.
      *
@@ -89,13 +196,118 @@ public:
      */
     [[nodiscard]] std::string text() const;
 
+    /**
+     * @brief Returns the text in the node without copying it.
+     *
+     * @return A view of the text stored in the tree, an empty view if the
+     *         node doesn't have text. The view is valid as long as the Tree
+     *         is alive.
+     *
+     * @see Node::text
+     */
+    [[nodiscard]] std::string_view text_view() const;
+
     /**
      * @brief Returns the joined text of children nodes.
      *
      * @return A string with the joined text of all children nodes with text.
+     *
+     * @see Node::inner_text_into
      */
     [[nodiscard]] std::string inner_text() const;
 
+    /**
+     * @brief Appends the joined text of children nodes to `out`.
+     *
+     * The text is measured first, so `out` grows at most once. Reusing
+     * `out` for several nodes avoids an allocation per call.
+     *
+     * @param out The string the text is appended to.
+     */
+    void inner_text_into(std::string& out) const;
+
+    /**
+     * @brief Copies the joined text of children nodes to `out`.
+     *
+     * @param out An output iterator accepting chars.
+     * @return The output iterator after the last copied char.
+     */
+    template <typename OutputIt>
+    OutputIt inner_text_copy(OutputIt out) const {
+        for_each_text([&](std::string_view text) {
+            out = std::copy(text.begin(), text.end(), out);
+        });
+
+        return out;
+    }
+
+    /**
+     * @brief Returns the text of the node as it is rendered.
+     *
+     * Unlike inner_text, the subtrees of the elements in
+     * `options.skip_tags` (script, style, noscript and template by default)
+     * are skipped without being visited, block elements are put on separate
+     * lines and whitespace is collapsed. All of it happens in one walk over
+     * the subtree.
+     *
+     * @param options Which elements to skip and how to format the text.
+     * @return The visible text of the node and its descendants.
+     */
+    [[nodiscard]] std::string
+    visible_text(const VisibleTextOptions& options = {}) const;
+
+    /**
+     * @brief Appends the visible text of the node to `out`.
+     *
+     * @see Node::visible_text
+     */
+    void visible_text_into(std::string& out,
+                           const VisibleTextOptions& options = {}) const;
+
+    /**
+     * @brief Returns the length of the joined text of children nodes.
+     */
+    [[nodiscard]] size_t inner_text_length() const;
+
+    /**
+     * @brief Calls `f` with the text of every text node in the subtree of
+     *        this node in document order.
+     *
+     * The subtree is walked iteratively, so deeply nested documents do not
+     * grow the stack.
+     *
+     * @param f A callable taking a std::string_view, the view is valid as
+     *        long as the Tree is alive.
+     */
+    template <typename Func>
+    void for_each_text(Func f) const {
+        constexpr auto text_tag = static_cast<myhtml_tag_id_t>(TAG::TEXT_);
+
+        // the same walk as walk_subtree, which lives in an internal header
+        // that is not installed, while this template is instantiated in
+        // user code.
+        myhtml_tree_node_t* node = m_raw_node;
+        while (node != nullptr) {
+            if (myhtml_node_tag_id(node) == text_tag) {
+                size_t length = 0;
+                if (const char* text = myhtml_node_text(node, &length)) {
+                    f(std::string_view(text, length));
+                }
+            }
+
+            if (myhtml_tree_node_t* child = myhtml_node_child(node)) {
+                node = child;
+                continue;
+            }
+
+            while (node != m_raw_node && myhtml_node_next(node) == nullptr) {
+                node = myhtml_node_parent(node);
+            }
+
+            node = node != m_raw_node ? myhtml_node_next(node) : nullptr;
+        }
+    }
+
     /**
      * @brief Returns the tag id of the node.
      *
@@ -112,6 +324,15 @@ public:
      */
     [[nodiscard]] std::string tag_name() const;
 
+    /**
+     * @brief Returns the tag name of the node without copying it.
+     *
+     * @return A view of the tag name, valid as long as the Tree is alive.
+     *
+     * @see Node::tag_name
+     */
+    [[nodiscard]] std::string_view tag_name_view() const;
+
     /**
      * @brief Returns the namespace of the node.
      *
@@ -192,6 +413,59 @@ public:
      */
     [[nodiscard]] std::vector<Node> siblings() const;
 
+    /**
+     * @brief Checks if the node is an ancestor of `other`.
+     *
+     * Takes constant time if the tree has an order index,
+     * otherwise walks the parents of `other`.
+     *
+     * @return true if `other` is a descendant of the node, false otherwise
+     *         (also if both nodes are equal).
+     *
+     * @see Tree::build_order_index
+     */
+    [[nodiscard]] bool is_ancestor_of(const Node& other) const;
+
+    /**
+     * @brief Returns the position of `other` relative to the node.
+     *
+     * Takes constant time if the tree has an order index.
+     *
+     * @return `CONTAINS` if `other` is an ancestor of the node,
+     *         `CONTAINED_BY` if it is a descendant, otherwise `PRECEDING` or
+     *         `FOLLOWING` depending on the document order, `EQUAL` for the
+     *         same node and `DISCONNECTED` for nodes of different trees.
+     *
+     * @see Tree::build_order_index
+     */
+    [[nodiscard]] DOCUMENT_POSITION document_position(const Node& other) const;
+
+    /**
+     * @brief Returns the number of nodes in the subtree of the node.
+     *
+     * Takes constant time if the tree has an order index,
+     * otherwise counts the nodes.
+     *
+     * @return The number of descendants of the node plus one.
+     */
+    [[nodiscard]] size_t subtree_size() const;
+
+    /**
+     * @brief Returns the position of the node in pre-order.
+     *
+     * @return An optional with the position if the tree has an order index,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<size_t> pre_order_index() const;
+
+    /**
+     * @brief Returns the position of the node in post-order.
+     *
+     * @return An optional with the position if the tree has an order index,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<size_t> post_order_index() const;
+
     /**
      * Returns an Attribute in the node with the key `key`.
      *
@@ -201,6 +475,18 @@ public:
      */
     [[nodiscard]] std::optional<std::string> at(const std::string& key) const;
 
+    /**
+     * Returns the value of the attribute with the key `key` without
+     * copying it.
+     *
+     * @param key the key of the attribute to access.
+     * @return Optional with a view of the value of the Attribute with the
+     *         key `key` if it exists, std::nullopt otherwise. The view is
+     *         valid as long as the Tree is alive.
+     */
+    [[nodiscard]] std::optional<std::string_view>
+    at_view(std::string_view key) const;
+
     /**
      * @brief Checks if the node has at least one attribute.
      *
@@ -330,6 +616,9 @@ public:
     [[nodiscard]] ConstIterator cend() const noexcept;
 
 private:
+    /// Gives the library internals access to the myhtml pointer.
+    friend struct RawAccess;
+
     /// Pointer to the underlying myhtml node struct.
     myhtml_tree_node_t* m_raw_node;
 };
@@ -339,4 +628,16 @@ private:
  */
 std::ostream& operator<<(std::ostream& os, const Node& n);
 
+/**
+ * @brief A comparator sorting nodes in document order.
+ *
+ * Compares two integers if the tree has an order index,
+ * otherwise compares the paths from the nodes to the document node.
+ *
+ * @see Tree::build_order_index
+ */
+struct DocumentOrder {
+    [[nodiscard]] bool operator()(const Node& lhs, const Node& rhs) const;
+};
+
 }  // namespace myhtmlpp
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "node.hpp"
+#include "tree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace myhtmlpp {
+
+class TreeInfo;
+
+/**
+ * @brief A set of nodes of one Tree.
+ *
+ * The set is a bitset over the pre-order numbering of the tree, so union,
+ * intersection and difference take O(n/64) time for a tree with n nodes,
+ * and iteration yields the nodes in document order.
+ *
+ * The tree must have an order index (see Tree::build_order_index) when the
+ * set is created, and a set becomes invalid when that index is cleared or
+ * rebuilt: all methods that look at the nodes of an invalid set throw
+ * std::logic_error.
+ */
+class NodeSet {
+public:
+    /**
+     * @brief NodeSet constructor.
+     *
+     * Creates an empty set for the nodes of `tree`.
+     *
+     * @throw std::logic_error if `tree` has no order index.
+     */
+    explicit NodeSet(const Tree& tree);
+
+    /**
+     * @brief NodeSet constructor.
+     *
+     * Creates a set containing `nodes`, e.g. the result of Tree::select.
+     *
+     * @throw std::logic_error if `tree` has no order index.
+     * @throw std::invalid_argument if one of `nodes` is not numbered by the
+     *        order index of `tree`.
+     */
+    NodeSet(const Tree& tree, const std::vector<Node>& nodes);
+
+    /**
+     * @brief Adds `node` to the set.
+     *
+     * @return true if `node` was not in the set before, false otherwise.
+     * @throw std::invalid_argument if `node` is not numbered by the order
+     *        index of the tree.
+     * @throw std::logic_error if the order index was cleared or rebuilt
+     *        since the set was created.
+     */
+    bool insert(const Node& node);
+
+    /**
+     * @brief Removes `node` from the set.
+     *
+     * @return true if `node` was in the set before, false otherwise.
+     */
+    bool erase(const Node& node);
+
+    /**
+     * @brief Checks if `node` is in the set.
+     */
+    [[nodiscard]] bool contains(const Node& node) const;
+
+    /**
+     * @brief Returns the number of nodes in the set.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Checks if the set is empty.
+     */
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * @brief Removes all nodes from the set.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the nodes of the set in document order.
+     */
+    [[nodiscard]] std::vector<Node> to_vector() const;
+
+    /**
+     * @brief Adds all nodes of `other` to the set.
+     *
+     * @throw std::invalid_argument if `other` belongs to a different tree.
+     */
+    NodeSet& operator|=(const NodeSet& other);
+
+    /**
+     * @brief Removes all nodes from the set that are not in `other`.
+     *
+     * @throw std::invalid_argument if `other` belongs to a different tree.
+     */
+    NodeSet& operator&=(const NodeSet& other);
+
+    /**
+     * @brief Removes all nodes of `other` from the set.
+     *
+     * @throw std::invalid_argument if `other` belongs to a different tree.
+     */
+    NodeSet& operator-=(const NodeSet& other);
+
+    /**
+     * @brief Checks if both sets contain the same nodes of the same tree.
+     */
+    [[nodiscard]] bool operator==(const NodeSet& other) const;
+
+    [[nodiscard]] bool operator!=(const NodeSet& other) const;
+
+    /// A NodeSet ConstIterator class, iterates in document order.
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Node;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        ConstIterator(const NodeSet* set, size_t position);
+
+        reference operator*() const;
+
+        ConstIterator& operator++();
+
+        bool operator==(const ConstIterator& other) const;
+        bool operator!=(const ConstIterator& other) const;
+
+    private:
+        const NodeSet* m_set;
+        size_t m_position;
+        Node m_node;
+    };
+
+    /**
+     * @brief Returns an iterator to the first node in document order.
+     */
+    [[nodiscard]] ConstIterator begin() const;
+
+    /**
+     * @brief Returns an iterator to after the last node.
+     */
+    [[nodiscard]] ConstIterator end() const;
+
+    [[nodiscard]] ConstIterator cbegin() const;
+
+    [[nodiscard]] ConstIterator cend() const;
+
+private:
+    /// Returns the pre-order position of `node` or `size_t(-1)` if it is
+    /// not numbered by the order index of the tree.
+    [[nodiscard]] size_t position(const Node& node) const;
+
+    /// Returns the first position >= `position` that is in the set,
+    /// or the number of nodes in the tree if there is none.
+    [[nodiscard]] size_t next_position(size_t position) const;
+
+    /// Throws if the order index the set was created with is gone.
+    void check_generation() const;
+
+    /// Throws if `other` belongs to a different tree.
+    void check_same_tree(const NodeSet& other) const;
+
+    /// Per-tree state with the pre-order numbering.
+    const TreeInfo* m_info;
+
+    /// The generation of the order index the positions refer to.
+    uint64_t m_generation;
+
+    /// Bit `i` is set if the node with the pre-order position `i` is in the
+    /// set.
+    std::vector<uint64_t> m_bits;
+};
+
+/**
+ * @brief Returns the union of `lhs` and `rhs`.
+ */
+[[nodiscard]] NodeSet operator|(NodeSet lhs, const NodeSet& rhs);
+
+/**
+ * @brief Returns the intersection of `lhs` and `rhs`.
+ */
+[[nodiscard]] NodeSet operator&(NodeSet lhs, const NodeSet& rhs);
+
+/**
+ * @brief Returns the nodes of `lhs` that are not in `rhs`.
+ */
+[[nodiscard]] NodeSet operator-(NodeSet lhs, const NodeSet& rhs);
+
+}  // namespace myhtmlpp
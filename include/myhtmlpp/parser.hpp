@@ -1,13 +1,150 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "constants.hpp"
+#include "error.hpp"
+#include "result.hpp"
 #include "tree.hpp"
 
 #include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mycore/myosi.h>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 
 namespace myhtmlpp {
 
+/**
+ * @brief Limits on the resources parsing a document may use, 0 for no
+ *        limit.
+ *
+ * Apart from `input_size`, the limits are checked as nodes are inserted
+ * into the tree, and parsing stops at the end of the current chunk of
+ * ParseOptions::chunk_size bytes when one is exceeded. Setting them parses
+ * the input in chunks like ParseOptions::stop does.
+ */
+struct ParseLimits {
+    /// The size of the input in bytes.
+    size_t input_size = 0;
+
+    /// The nesting depth of elements, `<html>` is at depth 1.
+    size_t depth = 0;
+
+    /// The number of nodes in the tree.
+    size_t nodes = 0;
+
+    /// The number of attributes of an element.
+    size_t attributes = 0;
+
+    /// The memory of the tree in bytes, estimated from the nodes,
+    /// attributes and text inserted into it.
+    size_t tree_memory = 0;
+
+    /// Return the tree parsed until a limit was exceeded instead of
+    /// throwing limit_exceeded. Input over `input_size` is not read.
+    bool truncate = false;
+};
+
+/// Options for parse and parse_fragment.
+struct ParseOptions {
+    /// The myhtml parse mode.
+    OPTION opt = OPTION::DEFAULT;
+
+    /// The number of myhtml threads.
+    size_t thread_count = 1;
+
+    /// The size of the myhtml token queue.
+    size_t queue_size = 4096;
+
+    /// The encoding of the input, myhtml decodes it to UTF-8 while
+    /// tokenizing. A byte order mark overrides it and is not parsed.
+    /// ENCODING::AUTO uses detect_encoding.
+    ENCODING encoding = ENCODING::UTF_8;
+
+    /// The encoding if ENCODING::AUTO detects none.
+    ENCODING fallback_encoding = ENCODING::UTF_8;
+
+    /// Take the myhtml instance from a pool kept by the library instead of
+    /// initializing a new one, and return it to the pool when the Tree is
+    /// destroyed. The pooled instances parse in myhtml's single mode,
+    /// `opt`, `thread_count` and `queue_size` are ignored.
+    bool reuse_engine = false;
+
+    /// Copy the source into the Tree, so Tree::source and Node::raw_html
+    /// stay valid after the parsed string is gone.
+    bool keep_source = false;
+
+    /// Drop comments while the tree is built.
+    bool drop_comments = false;
+
+    /// Drop the text of `<script>` elements while the tree is built, the
+    /// elements and their attributes are kept.
+    bool drop_script_text = false;
+
+    /// Drop the text of `<style>` elements while the tree is built, the
+    /// elements and their attributes are kept.
+    bool drop_style_text = false;
+
+    /// Drop text that only consists of whitespace while the tree is built,
+    /// except inside `<pre>`, `<textarea>`, `<listing>` and `<plaintext>`.
+    /// Whitespace between inline elements is dropped as well, e.g. the
+    /// space in `<b>a</b> <i>b</i>`.
+    bool drop_whitespace_text = false;
+
+    /// Stop parsing at a point of the document, e.g. when only the
+    /// metadata in the head is needed.
+    STOP stop = STOP::NEVER;
+
+    /// Stop parsing after this many bytes of the input, 0 to read all of
+    /// it.
+    size_t stop_after_bytes = 0;
+
+    /// Called for every node inserted into the tree, before its children
+    /// are; parsing stops after it returns true. If it throws, parsing
+    /// stops and the exception is rethrown by parse and try_parse alike.
+    std::function<bool(const Node&)> stop_when;
+
+    /// Limits for hostile input.
+    ParseLimits limits;
+
+    /// Checked before every chunk of the input, parsing throws
+    /// cancelled_error once it is cancelled.
+    std::optional<CancellationToken> cancellation;
+
+    /// If parsing can stop early, the input is passed to myhtml in chunks
+    /// of this size and the conditions are checked after every chunk, so
+    /// up to this many bytes are parsed past the point where parsing
+    /// stops. The tree is then built in myhtml's single mode, `opt` and
+    /// `thread_count` are ignored.
+    size_t chunk_size = 4096;
+};
+
+/// The number of bytes detect_encoding scans for a `<meta>` charset.
+inline constexpr size_t encoding_prescan_size = 1024;
+
+/**
+ * @brief Detects the encoding of a HTML document as a browser does before
+ *        parsing it.
+ *
+ * A byte order mark is checked first, then the first
+ * `encoding_prescan_size` bytes are scanned for a `<meta charset>` or
+ * `<meta http-equiv="content-type">`. As in the HTML standard, a UTF-16
+ * meta charset is read as UTF-8 and x-user-defined as windows-1252.
+ *
+ * @param html The start of the document, or all of it.
+ * @return Optional with the encoding, std::nullopt if there is no byte
+ *         order mark and no meta charset.
+ */
+[[nodiscard]] std::optional<ENCODING> detect_encoding(std::string_view html);
+
 /**
  * @brief Parses a HTML string into a Tree structure with the given options.
  *
@@ -19,6 +156,23 @@ namespace myhtmlpp {
 Tree parse(const std::string& html, OPTION opt = OPTION::DEFAULT,
            size_t thread_count = 1, size_t queue_size = 4096);
 
+/**
+ * @brief Parses a HTML string into a Tree structure with the given options.
+ *
+ * If parsing stops early (see ParseOptions::stop), the Tree holds the
+ * nodes parsed so far, with the open elements closed as at the end of
+ * the input.
+ *
+ * @param html The HTML code that will be parsed.
+ * @param options How to parse `html`.
+ * @throw std::runtime_error if one of myhtml_init, myhtml_tree_init
+ *        or myhtml_parse does not return MyHTML_STATUS_OK.
+ * @throw limit_exceeded if `html` exceeds one of `options.limits`.
+ * @throw cancelled_error if `options.cancellation` is cancelled.
+ * @return A Tree with the parsed HTML nodes.
+ */
+Tree parse(const std::string& html, const ParseOptions& options);
+
 /**
  * @brief Parses a fragment of a HTML string into a Tree structure.
  *
@@ -32,4 +186,138 @@ Tree parse_fragment(const std::string& html, TAG tag_id = TAG::DIV,
                     OPTION opt = OPTION::DEFAULT, size_t thread_count = 1,
                     size_t queue_size = 4096);
 
+/**
+ * @brief Parses a fragment of a HTML string into a Tree structure with the
+ *        given options.
+ *
+ * @param html The HTML code that will be parsed.
+ * @param options How to parse `html`.
+ * @throw std::runtime_error if one of myhtml_init, myhtml_tree_init
+ *        or myhtml_parse_fragment does not return MyHTML_STATUS_OK.
+ * @throw limit_exceeded if `html` exceeds one of `options.limits`.
+ * @throw cancelled_error if `options.cancellation` is cancelled.
+ * @return A Tree with the parsed HTML nodes.
+ */
+Tree parse_fragment(const std::string& html, const ParseOptions& options,
+                    TAG tag_id = TAG::DIV, NAMESPACE ns = NAMESPACE::HTML);
+
+/**
+ * @brief Parses a HTML string into a Tree structure without throwing the
+ *        exceptions of the library.
+ *
+ * @param html The HTML code that will be parsed.
+ * @param options How to parse `html`.
+ * Exceptions thrown by ParseOptions::stop_when are not failures of the
+ * library and have no status, they are rethrown.
+ *
+ * @return The Tree, or the status of the failure: the status of
+ *         myhtml_init, myhtml_tree_init or myhtml_parse,
+ *         `limit_exceeded_status` or `cancelled_status`.
+ */
+[[nodiscard]] Result<Tree, mystatus_t>
+try_parse(const std::string& html, const ParseOptions& options = {});
+
+/**
+ * @brief Parses a fragment of a HTML string into a Tree structure without
+ *        throwing the exceptions of the library.
+ *
+ * @see try_parse
+ */
+[[nodiscard]] Result<Tree, mystatus_t>
+try_parse_fragment(const std::string& html, const ParseOptions& options = {},
+                   TAG tag_id = TAG::DIV, NAMESPACE ns = NAMESPACE::HTML);
+
+/// Runs a job on another thread, e.g. by posting it to a thread pool or
+/// an event loop. With asio: `[&](auto job) { asio::post(pool, job); }`.
+using Executor = std::function<void(std::function<void()>)>;
+
+/**
+ * @brief Returns an Executor that runs jobs on the thread pool shared by
+ *        the library.
+ */
+[[nodiscard]] Executor shared_executor();
+
+/**
+ * @brief Parses a HTML string on `executor` instead of the calling thread.
+ *
+ * The parse takes its myhtml instance from the pool of the library (see
+ * ParseOptions::reuse_engine) and copies the source into the Tree (see
+ * ParseOptions::keep_source), whatever `options` says.
+ *
+ * @param html The HTML code that will be parsed.
+ * @param options How to parse `html`.
+ * @param executor Runs the parse.
+ * @return A future for the Tree, or for the exception `parse` throws.
+ */
+[[nodiscard]] std::future<Tree>
+parse_async(std::string html, ParseOptions options = {},
+            Executor executor = shared_executor());
+
+#if defined(__cpp_impl_coroutine)
+
+/**
+ * @brief The awaitable returned by parse_awaitable.
+ *
+ * The awaiting coroutine is suspended while the HTML is parsed and resumed
+ * on the thread of the executor.
+ */
+class ParseAwaitable {
+public:
+    ParseAwaitable(std::string html, ParseOptions options, Executor executor)
+        : m_html(std::move(html)), m_options(std::move(options)),
+          m_executor(std::move(executor)) {
+        m_options.keep_source = true;
+        m_options.reuse_engine = true;
+    }
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // the coroutine may finish and destroy the awaitable before the
+        // executor returns, e.g. if it runs the job inline or another thread
+        // picks it up right away, so the executor is called from a copy.
+        Executor executor = m_executor;
+        executor([this, handle] {
+            try {
+                m_tree.emplace(parse(m_html, m_options));
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+            handle.resume();
+        });
+    }
+
+    Tree await_resume() {
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+
+        return std::move(*m_tree);
+    }
+
+private:
+    std::string m_html;
+    ParseOptions m_options;
+    Executor m_executor;
+
+    std::optional<Tree> m_tree;
+    std::exception_ptr m_error;
+};
+
+/**
+ * @brief Parses a HTML string on `executor` from a C++20 coroutine:
+ *        `Tree tree = co_await parse_awaitable(html);`.
+ *
+ * @see parse_async
+ * @throw The exceptions of `parse` when it is resumed.
+ */
+[[nodiscard]] inline ParseAwaitable
+parse_awaitable(std::string html, ParseOptions options = {},
+                Executor executor = shared_executor()) {
+    return ParseAwaitable(std::move(html), std::move(options),
+                          std::move(executor));
+}
+
+#endif
+
 }  // namespace myhtmlpp
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <utility>
+#include <variant>
+
+namespace myhtmlpp {
+
+/// The error of a Result, wrapped to tell it apart from a value.
+template <typename E>
+struct Failure {
+    E error;
+};
+
+template <typename E>
+Failure(E) -> Failure<E>;
+
+/**
+ * @brief Either a value or an error, returned by the functions that report
+ *        failures without throwing, e.g. try_parse.
+ *
+ * A Result converts from a value and from a Failure:
+ *
+ *     Result<Tree, mystatus_t> ok = std::move(tree);
+ *     Result<Tree, mystatus_t> failed = Failure{status};
+ */
+template <typename T, typename E>
+class Result {
+public:
+    Result(T value) : m_storage(std::in_place_index<0>, std::move(value)) {}
+
+    Result(Failure<E> failure)
+        : m_storage(std::in_place_index<1>, std::move(failure.error)) {}
+
+    /**
+     * @brief Checks if the result holds a value.
+     */
+    [[nodiscard]] bool has_value() const noexcept {
+        return m_storage.index() == 0;
+    }
+
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return has_value();
+    }
+
+    /**
+     * @brief Returns the value.
+     *
+     * @throw std::bad_variant_access if the result holds an error.
+     */
+    [[nodiscard]] T& value() & { return std::get<0>(m_storage); }
+
+    [[nodiscard]] const T& value() const& { return std::get<0>(m_storage); }
+
+    [[nodiscard]] T&& value() && { return std::get<0>(std::move(m_storage)); }
+
+    /**
+     * @brief Returns the error.
+     *
+     * @throw std::bad_variant_access if the result holds a value.
+     */
+    [[nodiscard]] const E& error() const { return std::get<1>(m_storage); }
+
+    /**
+     * @brief Returns the value, the result must hold one.
+     */
+    [[nodiscard]] T& operator*() & { return *std::get_if<0>(&m_storage); }
+
+    [[nodiscard]] const T& operator*() const& {
+        return *std::get_if<0>(&m_storage);
+    }
+
+    [[nodiscard]] T* operator->() { return std::get_if<0>(&m_storage); }
+
+    [[nodiscard]] const T* operator->() const {
+        return std::get_if<0>(&m_storage);
+    }
+
+private:
+    std::variant<T, E> m_storage;
+};
+
+}  // namespace myhtmlpp
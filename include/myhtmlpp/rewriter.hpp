@@ -0,0 +1,136 @@
+#pragma once
+
+#include "node.hpp"
+#include "serialization.hpp"
+#include "tree.hpp"
+
+#include <cstddef>
+#include <myhtml/myhtml.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace myhtmlpp {
+
+/**
+ * @brief Rewrites the source of a Tree by splicing edits into it.
+ *
+ * Edits are recorded against the nodes of the parsed tree and applied to
+ * Tree::source when the output is produced: the source between the edited
+ * nodes is copied verbatim, only the edited parts are written anew. So
+ * the cost of a rewrite beyond copying the source grows with the number of
+ * edits, not with the size of the document, and the formatting of the
+ * untouched markup is kept.
+ *
+ * The tree itself is not modified. Edits inside a node that is removed or
+ * replaced are dropped, and an element whose attributes are edited gets a
+ * freshly serialized start tag.
+ *
+ * The Tree and its source must outlive the Rewriter.
+ */
+class Rewriter {
+public:
+    /**
+     * @brief Rewriter constructor.
+     *
+     * @param tree The tree whose source is rewritten.
+     */
+    explicit Rewriter(const Tree& tree);
+
+    /**
+     * @brief Sets the attribute `key` of `element` to `value`, adding it
+     *        after the existing attributes if it is not there yet.
+     *
+     * @throw std::invalid_argument if `element` is not an element with a
+     *        start tag in the source.
+     */
+    void set_attribute(const Node& element, std::string_view key,
+                       std::string_view value);
+
+    /**
+     * @brief Removes the attribute `key` of `element` if it exists.
+     *
+     * @throw std::invalid_argument if `element` is not an element with a
+     *        start tag in the source.
+     */
+    void remove_attribute(const Node& element, std::string_view key);
+
+    /**
+     * @brief Replaces the markup of `node` and its descendants with `html`.
+     *
+     * @param node The node to replace.
+     * @param html Markup that is written as it is.
+     * @throw std::invalid_argument if `node` has no source range.
+     */
+    void replace(const Node& node, std::string_view html);
+
+    /**
+     * @brief Removes the markup of `node` and its descendants.
+     *
+     * @throw std::invalid_argument if `node` has no source range.
+     */
+    void remove(const Node& node);
+
+    /**
+     * @brief Inserts `html` right before the markup of `node`.
+     *
+     * @throw std::invalid_argument if `node` has no source range.
+     */
+    void insert_before(const Node& node, std::string_view html);
+
+    /**
+     * @brief Inserts `html` right after the markup of `node`.
+     *
+     * @throw std::invalid_argument if `node` has no source range.
+     */
+    void insert_after(const Node& node, std::string_view html);
+
+    /**
+     * @brief Returns the number of recorded edits.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Returns the rewritten source.
+     */
+    [[nodiscard]] std::string html() const;
+
+    /**
+     * @brief Writes the rewritten source to `sink`.
+     *
+     * The unchanged parts of the source are passed to `sink` as views into
+     * Tree::source, without copying them first.
+     */
+    void write_html(const Sink& sink) const;
+
+private:
+    /// Replaces `[begin, end)` of the source with `text`.
+    struct Splice {
+        size_t begin;
+        size_t end;
+        std::string text;
+    };
+
+    /// The attributes of an element with edited attributes.
+    struct StartTag {
+        size_t splice;
+        std::vector<std::pair<std::string, std::string>> attributes;
+    };
+
+    /// Returns the source range of `node`.
+    [[nodiscard]] SourceRange range_of(const Node& node) const;
+
+    /// Returns the start tag of `element`, recording it on the first call.
+    StartTag& start_tag(const Node& element);
+
+    /// Serializes the start tag of `element` with `tag.attributes`.
+    void update_start_tag(const Node& element, StartTag& tag);
+
+    std::string_view m_source;
+    std::vector<Splice> m_splices;
+    std::unordered_map<myhtml_tree_node_t*, StartTag> m_start_tags;
+};
+
+}  // namespace myhtmlpp
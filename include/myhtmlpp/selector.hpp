@@ -0,0 +1,75 @@
+#pragma once
+
+#include "constants.hpp"
+#include "result.hpp"
+
+#include <memory>
+#include <mycore/myosi.h>
+#include <string>
+#include <string_view>
+
+namespace myhtmlpp {
+
+struct SelectorData;
+
+/**
+ * @brief A css selector that is parsed once and matched many times.
+ *
+ * The selector is parsed with mycss, the same way Tree::select parses its
+ * argument on every call. A Selector can be passed to Tree::select
+ * repeatedly and to StreamRewriter::on.
+ */
+class Selector {
+public:
+    /**
+     * @brief Selector constructor.
+     *
+     * @param selector The css selector, e.g. `div.item > a[href]`.
+     * @throw selector_error if `selector` is not a valid selector.
+     */
+    explicit Selector(std::string_view selector);
+
+    /**
+     * @brief Parses `selector` without throwing.
+     *
+     * @return The Selector, or the status of mycss if it can not be
+     *         initialized, `invalid_selector_status` if `selector` is not a
+     *         valid selector.
+     */
+    [[nodiscard]] static Result<Selector, mystatus_t>
+    try_create(std::string_view selector);
+
+    ~Selector();
+
+    Selector(const Selector&) = delete;
+    Selector& operator=(const Selector&) = delete;
+
+    Selector(Selector&& other) noexcept;
+    Selector& operator=(Selector&& other) noexcept;
+
+    /**
+     * @brief Returns the selector as it was passed to the constructor.
+     */
+    [[nodiscard]] const std::string& text() const;
+
+    /**
+     * @brief Checks if the selector can be matched against the open
+     *        elements of a stream.
+     *
+     * That is the case if it only uses type, universal, id, class and
+     * attribute selectors combined with descendant and child combinators.
+     * Pseudo-classes and sibling combinators depend on nodes the stream
+     * has not seen or no longer knows.
+     */
+    [[nodiscard]] bool streamable() const;
+
+private:
+    friend struct RawAccess;
+
+    Selector(std::string_view selector, std::unique_ptr<SelectorData> data);
+
+    std::string m_text;
+    std::unique_ptr<SelectorData> m_data;
+};
+
+}  // namespace myhtmlpp
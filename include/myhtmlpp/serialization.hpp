@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/**
+ * @brief Receives serialized HTML in consecutive chunks.
+ *
+ * A chunk is only valid during the call. Exceptions thrown by the sink stop
+ * the serialization and are rethrown to the caller of `write_html`.
+ */
+using Sink = std::function<void(std::string_view)>;
+
+/**
+ * @brief Options for serializing a (sub)tree, e.g. to minify it.
+ *
+ * With the default options the output is the same as the one of myhtml's
+ * serializer. Otherwise the library serializes the tree itself and applies
+ * the options while it writes the output, in one pass.
+ */
+struct SerializeOptions {
+    /// Drop comments.
+    bool drop_comments = false;
+
+    /// Replace runs of whitespace in text with a single space and drop
+    /// whitespace-only text between block elements and in elements like
+    /// `<ul>` or `<table>` where it is not rendered. The text inside of
+    /// `<pre>`, `<textarea>`, `<script>` and `<style>` is kept as is.
+    bool collapse_whitespace = false;
+
+    /// Write attribute values without quotes where the syntax allows it and
+    /// empty attribute values as the attribute name only.
+    bool omit_optional_quotes = false;
+
+    /// Omit end tags that the parser infers, e.g. `</li>` before the next
+    /// `<li>` or `</p>` before a block element.
+    bool omit_optional_end_tags = false;
+
+    /// Keys of attributes that are not written, e.g. `{"style"}`.
+    std::vector<std::string> skip_attributes;
+
+    /**
+     * @brief Returns options with all minifications enabled.
+     */
+    [[nodiscard]] static SerializeOptions minify();
+};
+
+/**
+ * @brief Returns a Sink that writes to `os`.
+ *
+ * `os` must outlive the sink.
+ */
+[[nodiscard]] Sink ostream_sink(std::ostream& os);
+
+/**
+ * @brief Returns a Sink that writes to the file descriptor `fd`.
+ *
+ * The sink retries interrupted and partial writes and does not close `fd`.
+ *
+ * @throw std::system_error if `write` fails.
+ */
+[[nodiscard]] Sink fd_sink(int fd);
+
+}  // namespace myhtmlpp
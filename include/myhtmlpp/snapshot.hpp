@@ -0,0 +1,204 @@
+#pragma once
+
+#include "constants.hpp"
+#include "node.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <myhtml/myhtml.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// Index of a node inside a Snapshot.
+struct NodeRef {
+    uint32_t index;
+
+    [[nodiscard]] bool operator==(const NodeRef& other) const {
+        return index == other.index;
+    }
+
+    [[nodiscard]] bool operator!=(const NodeRef& other) const {
+        return index != other.index;
+    }
+
+    [[nodiscard]] bool operator<(const NodeRef& other) const {
+        return index < other.index;
+    }
+};
+
+/**
+ * @brief A flattened, read-only copy of a (sub)tree.
+ *
+ * The nodes are stored in pre-order as a structure of arrays: tag ids,
+ * parent indices, subtree end indices and depths each live in their own
+ * contiguous vector, and the text and attributes of all nodes are copied
+ * into one shared arena. Scans over a column are linear sweeps over
+ * contiguous memory instead of pointer chasing through myhtml nodes.
+ *
+ * The subtree of the node `i` is the range `[i, subtree_ends()[i])`.
+ * Offsets are 32 bit, so the text and attributes of a snapshot are
+ * limited to 4 GiB.
+ *
+ * A Snapshot does not change when the Tree changes. The Node handles
+ * returned by `node` are only valid as long as the Tree is alive.
+ */
+class Snapshot {
+public:
+    /// Parent index of the root node.
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    /// Tag id stored for custom tags that do not fit into 16 bits.
+    static constexpr uint16_t overflow_tag =
+        std::numeric_limits<uint16_t>::max();
+
+    /**
+     * @brief Snapshot constructor.
+     *
+     * Copies the subtree of `root` (including `root` itself).
+     *
+     * @param root The root node of the snapshot.
+     */
+    explicit Snapshot(const Node& root);
+
+    /**
+     * @brief Returns the number of nodes in the snapshot.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Returns the tag ids of all nodes in pre-order.
+     */
+    [[nodiscard]] const std::vector<uint16_t>& tags() const;
+
+    /**
+     * @brief Returns the parent indices of all nodes in pre-order,
+     *        `npos` for the root node.
+     */
+    [[nodiscard]] const std::vector<uint32_t>& parents() const;
+
+    /**
+     * @brief Returns for every node the index after its last descendant.
+     */
+    [[nodiscard]] const std::vector<uint32_t>& subtree_ends() const;
+
+    /**
+     * @brief Returns the depths of all nodes relative to the root node.
+     */
+    [[nodiscard]] const std::vector<uint32_t>& depths() const;
+
+    /**
+     * @brief Returns the reference to the root node.
+     */
+    [[nodiscard]] NodeRef root() const;
+
+    /**
+     * @brief Returns the tag id of the node `ref`.
+     */
+    [[nodiscard]] TAG tag_id(NodeRef ref) const;
+
+    /**
+     * @brief Returns the parent of the node `ref`.
+     *
+     * @return An optional with the parent if `ref` is not the root node,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<NodeRef> parent(NodeRef ref) const;
+
+    /**
+     * @brief Returns the index after the last descendant of the node `ref`.
+     */
+    [[nodiscard]] uint32_t subtree_end(NodeRef ref) const;
+
+    /**
+     * @brief Returns the depth of the node `ref` relative to the root node.
+     */
+    [[nodiscard]] uint32_t depth(NodeRef ref) const;
+
+    /**
+     * @brief Returns the text of the node `ref`.
+     *
+     * @return The text of text and comment nodes, an empty string_view for
+     *         all other nodes. It points into the snapshot.
+     */
+    [[nodiscard]] std::string_view text(NodeRef ref) const;
+
+    /**
+     * @brief Returns the number of attributes of the node `ref`.
+     */
+    [[nodiscard]] size_t attribute_count(NodeRef ref) const;
+
+    /**
+     * @brief Returns the key of the `i`-th attribute of the node `ref`.
+     */
+    [[nodiscard]] std::string_view attribute_key(NodeRef ref, size_t i) const;
+
+    /**
+     * @brief Returns the value of the `i`-th attribute of the node `ref`.
+     */
+    [[nodiscard]] std::string_view attribute_value(NodeRef ref,
+                                                   size_t i) const;
+
+    /**
+     * @brief Returns the value of the attribute with the key `key`.
+     *
+     * @return Optional with the value if the node has an attribute with the
+     *         key `key`, std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::string_view>
+    attribute(NodeRef ref, std::string_view key) const;
+
+    /**
+     * @brief Converts `ref` back to a Node of the Tree.
+     */
+    [[nodiscard]] Node node(NodeRef ref) const;
+
+    /**
+     * @brief Returns the number of nodes with the tag `tag`.
+     *
+     * Tags from `overflow_tag` on are compared by the tag id of their
+     * node, which is slower than the scan of the tag column.
+     */
+    [[nodiscard]] size_t count(TAG tag) const;
+
+    /**
+     * @brief Returns all nodes with the tag `tag` in document order.
+     */
+    [[nodiscard]] std::vector<NodeRef> find_by_tag(TAG tag) const;
+
+private:
+    /// Position of an attribute key and value in the arena.
+    struct AttributeEntry {
+        uint32_t key_offset;
+        uint32_t key_length;
+        uint32_t value_offset;
+        uint32_t value_length;
+    };
+
+    std::vector<uint16_t> m_tags;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_subtree_ends;
+    std::vector<uint32_t> m_depths;
+
+    /// The text of the node `i` is the arena range
+    /// `[m_text_offsets[i], m_text_offsets[i + 1])`.
+    std::vector<uint32_t> m_text_offsets;
+
+    /// Attributes of the node `i` are
+    /// `m_attributes[m_attribute_offsets[i], m_attribute_offsets[i + 1])`.
+    std::vector<uint32_t> m_attribute_offsets;
+    std::vector<AttributeEntry> m_attributes;
+
+    /// The text of all nodes in pre-order, followed by all attribute keys
+    /// and values.
+    std::string m_arena;
+
+    /// The myhtml nodes, to convert a NodeRef back to a Node.
+    std::vector<myhtml_tree_node_t*> m_nodes;
+};
+
+}  // namespace myhtmlpp
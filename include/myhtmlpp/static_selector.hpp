@@ -0,0 +1,413 @@
+#pragma once
+
+#include "constants.hpp"
+#include "error.hpp"
+#include "selector.hpp"
+#include "tag_names.hpp"
+
+#include <array>
+#include <cstddef>
+#include <myhtml/myhtml.h>
+#include <string_view>
+
+namespace myhtmlpp {
+
+/**
+ * @brief A css selector that is parsed by the compiler.
+ *
+ * Type, universal, id, class and attribute selectors combined with
+ * descendant and child combinators and separated by commas are compiled
+ * into compound selectors with tag ids and attribute keys, which
+ * Tree::select matches while walking the tree without involving mycss.
+ *
+ * Other valid css, e.g. pseudo-classes, sibling combinators, escapes or
+ * upper case names, is not compiled: `compiled()` returns false and
+ * Tree::select parses the text with mycss on every call instead.
+ *
+ * The parser is constexpr, so a StaticSelector declared `constexpr` is
+ * checked at compile time and a malformed selector does not compile:
+ *
+ *     using namespace myhtmlpp::literals;
+ *     constexpr auto links = "div.item > a[href]"_sel;
+ */
+class StaticSelector {
+public:
+    /// The maximum number of compound selectors over all alternatives.
+    static constexpr size_t max_compounds = 8;
+
+    /// The maximum number of attribute conditions over all compounds.
+    static constexpr size_t max_conditions = 16;
+
+    /// An attribute condition, ids and classes are conditions on the `id`
+    /// and `class` attributes.
+    struct Condition {
+        std::string_view key;
+        std::string_view value;
+        ATTRIBUTE_MATCH match = ATTRIBUTE_MATCH::EXISTS;
+        bool ignore_case = false;
+    };
+
+    /// A compound selector, e.g. `a.external[href]`.
+    struct Compound {
+        /// Whether the element must be a child of the element matching the
+        /// compound before this one, or just a descendant.
+        bool child = false;
+
+        /// Whether the compound has no type selector or `*`.
+        bool any_tag = true;
+
+        /// The id of the tag, TAG::UNDEF_ for custom tags.
+        TAG tag_id = TAG::UNDEF_;
+        std::string_view tag_name;
+
+        /// The range of the conditions of the compound.
+        size_t conditions_begin = 0;
+        size_t conditions_end = 0;
+    };
+
+    /**
+     * @brief StaticSelector constructor.
+     *
+     * @param selector The css selector, it must outlive the StaticSelector
+     *        (string literals do).
+     * @throw selector_error if `selector` is malformed, which is a compile
+     *        error in a constant expression.
+     */
+    constexpr explicit StaticSelector(std::string_view selector)
+        : m_text(selector) {
+        parse();
+    }
+
+    /**
+     * @brief Returns the selector as it was passed to the constructor.
+     */
+    [[nodiscard]] constexpr std::string_view text() const { return m_text; }
+
+    /**
+     * @brief Checks if the selector was compiled, i.e. is matched without
+     *        mycss.
+     */
+    [[nodiscard]] constexpr bool compiled() const { return m_compiled; }
+
+    /**
+     * @brief Returns the number of comma separated alternatives, 0 if the
+     *        selector was not compiled.
+     */
+    [[nodiscard]] constexpr size_t alternatives() const {
+        return m_alternative_count;
+    }
+
+    /**
+     * @brief Returns the compound selector `index` over all alternatives,
+     *        from left to right.
+     */
+    [[nodiscard]] constexpr const Compound& compound(size_t index) const {
+        return m_compounds[index];
+    }
+
+    /**
+     * @brief Returns the number of compound selectors over all
+     *        alternatives.
+     */
+    [[nodiscard]] constexpr size_t compounds() const {
+        return m_compound_count;
+    }
+
+private:
+    friend class Tree;
+
+    static constexpr bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+    }
+
+    static constexpr bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    static constexpr bool is_name_char(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               is_digit(c) || c == '-' || c == '_' ||
+               static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    // valid css that is left to mycss
+    static constexpr bool is_unsupported(char c) {
+        return c == ':' || c == '+' || c == '~' || c == '\\' || c == '|';
+    }
+
+    static constexpr bool has_upper(std::string_view name) {
+        for (char c : name) {
+            if (c >= 'A' && c <= 'Z') {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    constexpr void check(bool valid) const {
+        if (!valid) {
+            throw selector_error(invalid_selector_status, m_text);
+        }
+    }
+
+    constexpr size_t skip_spaces(size_t pos) const {
+        while (pos < m_text.size() && is_space(m_text[pos])) {
+            ++pos;
+        }
+
+        return pos;
+    }
+
+    constexpr size_t name_end(size_t pos) const {
+        while (pos < m_text.size() && is_name_char(m_text[pos])) {
+            ++pos;
+        }
+
+        return pos;
+    }
+
+    // gives up compiling, returns the end of the text to stop parsing
+    constexpr size_t unsupported() {
+        m_compiled = false;
+        m_compound_count = 0;
+        m_condition_count = 0;
+        m_alternative_count = 0;
+
+        return m_text.size();
+    }
+
+    constexpr void parse() {
+        size_t pos = skip_spaces(0);
+        check(pos < m_text.size());
+
+        while (m_compiled) {
+            bool child = false;
+            while (m_compiled) {
+                pos = parse_compound(pos, child);
+                if (!m_compiled) {
+                    return;
+                }
+
+                size_t next = skip_spaces(pos);
+                bool spaces = next != pos;
+                pos = next;
+                if (pos == m_text.size() || m_text[pos] == ',') {
+                    break;
+                }
+
+                if (m_text[pos] == '>') {
+                    child = true;
+                    pos = skip_spaces(pos + 1);
+                } else if (spaces) {
+                    child = false;
+                } else {
+                    check(is_unsupported(m_text[pos]));
+                    unsupported();
+                    return;
+                }
+            }
+
+            m_alternative_ends[m_alternative_count++] = m_compound_count;
+            if (pos == m_text.size()) {
+                return;
+            }
+
+            pos = skip_spaces(pos + 1);
+            check(pos < m_text.size());
+        }
+    }
+
+    constexpr size_t parse_compound(size_t pos, bool child) {
+        if (pos < m_text.size() && is_unsupported(m_text[pos])) {
+            return unsupported();
+        }
+        if (m_compound_count == max_compounds) {
+            return unsupported();
+        }
+
+        Compound& compound = m_compounds[m_compound_count++];
+        compound.child = child;
+        compound.conditions_begin = m_condition_count;
+
+        size_t begin = pos;
+        if (pos < m_text.size() && m_text[pos] == '*') {
+            ++pos;
+        } else if (pos < m_text.size() && is_name_char(m_text[pos])) {
+            check(!is_digit(m_text[pos]));
+
+            size_t end = name_end(pos);
+            std::string_view name = m_text.substr(pos, end - pos);
+            if (has_upper(name)) {
+                return unsupported();
+            }
+
+            compound.any_tag = false;
+            compound.tag_id = tag_from_name(name);
+            compound.tag_name = name;
+            pos = end;
+        }
+
+        while (pos < m_text.size() && m_compiled) {
+            char c = m_text[pos];
+            if (c == '#' || c == '.') {
+                size_t end = name_end(pos + 1);
+                if (end == pos + 1) {
+                    check(end < m_text.size() && m_text[end] == '\\');
+                    return unsupported();
+                }
+                check(!is_digit(m_text[pos + 1]));
+
+                add_condition(c == '#' ? "id" : "class",
+                              m_text.substr(pos + 1, end - pos - 1),
+                              c == '#' ? ATTRIBUTE_MATCH::EQUAL
+                                       : ATTRIBUTE_MATCH::INCLUDE,
+                              false);
+                pos = end;
+            } else if (c == '[') {
+                pos = parse_attribute(pos + 1);
+            } else {
+                break;
+            }
+        }
+
+        check(pos != begin);
+        compound.conditions_end = m_condition_count;
+
+        return pos;
+    }
+
+    constexpr size_t parse_attribute(size_t pos) {
+        pos = skip_spaces(pos);
+        size_t key_end = name_end(pos);
+        if (key_end == pos) {
+            check(pos < m_text.size() && is_unsupported(m_text[pos]));
+            return unsupported();
+        }
+
+        std::string_view key = m_text.substr(pos, key_end - pos);
+        if (has_upper(key)) {
+            return unsupported();
+        }
+
+        pos = skip_spaces(key_end);
+        check(pos < m_text.size());
+        if (m_text[pos] == ']') {
+            add_condition(key, {}, ATTRIBUTE_MATCH::EXISTS, false);
+            return pos + 1;
+        }
+
+        auto match = ATTRIBUTE_MATCH::EQUAL;
+        if (m_text[pos] == '=') {
+            ++pos;
+        } else {
+            check(pos + 1 < m_text.size() && m_text[pos + 1] == '=');
+            switch (m_text[pos]) {
+                case '~':
+                    match = ATTRIBUTE_MATCH::INCLUDE;
+                    break;
+                case '|':
+                    match = ATTRIBUTE_MATCH::DASH;
+                    break;
+                case '^':
+                    match = ATTRIBUTE_MATCH::PREFIX;
+                    break;
+                case '$':
+                    match = ATTRIBUTE_MATCH::SUFFIX;
+                    break;
+                case '*':
+                    match = ATTRIBUTE_MATCH::SUBSTRING;
+                    break;
+                default:
+                    check(false);
+            }
+            pos += 2;
+        }
+
+        pos = skip_spaces(pos);
+        check(pos < m_text.size());
+
+        std::string_view value;
+        char quote = m_text[pos];
+        if (quote == '"' || quote == '\'') {
+            size_t end = pos + 1;
+            while (end < m_text.size() && m_text[end] != quote) {
+                if (m_text[end] == '\\') {
+                    return unsupported();
+                }
+                ++end;
+            }
+            check(end < m_text.size());
+
+            value = m_text.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+        } else {
+            size_t end = name_end(pos);
+            if (end == pos) {
+                check(m_text[pos] == '\\');
+                return unsupported();
+            }
+
+            value = m_text.substr(pos, end - pos);
+            pos = end;
+        }
+
+        pos = skip_spaces(pos);
+        bool ignore_case = false;
+        if (pos < m_text.size() && (m_text[pos] == 'i' || m_text[pos] == 'I')) {
+            ignore_case = true;
+            pos = skip_spaces(pos + 1);
+        } else if (pos < m_text.size() &&
+                   (m_text[pos] == 's' || m_text[pos] == 'S')) {
+            pos = skip_spaces(pos + 1);
+        }
+
+        check(pos < m_text.size() && m_text[pos] == ']');
+        add_condition(key, value, match, ignore_case);
+
+        return pos + 1;
+    }
+
+    constexpr void add_condition(std::string_view key, std::string_view value,
+                                 ATTRIBUTE_MATCH match, bool ignore_case) {
+        if (m_condition_count == max_conditions) {
+            unsupported();
+            return;
+        }
+
+        m_conditions[m_condition_count++] = {key, value, match, ignore_case};
+    }
+
+    [[nodiscard]] bool matches(myhtml_tree_node_t* node) const;
+
+    [[nodiscard]] bool matches_at(size_t first, size_t index,
+                                  myhtml_tree_node_t* node) const;
+
+    [[nodiscard]] bool matches_compound(const Compound& compound,
+                                        myhtml_tree_node_t* node) const;
+
+    std::string_view m_text;
+    bool m_compiled = true;
+
+    std::array<Compound, max_compounds> m_compounds{};
+    size_t m_compound_count = 0;
+
+    std::array<Condition, max_conditions> m_conditions{};
+    size_t m_condition_count = 0;
+
+    /// The end of the compounds of every alternative.
+    std::array<size_t, max_compounds> m_alternative_ends{};
+    size_t m_alternative_count = 0;
+};
+
+inline namespace literals {
+
+/**
+ * @brief Creates a StaticSelector from a string literal, e.g.
+ *        `"ul > li.item"_sel`.
+ */
+constexpr StaticSelector operator""_sel(const char* selector, size_t length) {
+    return StaticSelector(std::string_view(selector, length));
+}
+
+}  // namespace literals
+
+}  // namespace myhtmlpp
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "constants.hpp"
+#include "selector.hpp"
+#include "serialization.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <myhtml/myhtml.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace myhtmlpp {
+
+/**
+ * @brief An element of a stream, passed to the handlers of a
+ *        StreamRewriter when its start tag is read.
+ *
+ * Only the start tag has been read at that point, so the element has
+ * attributes but no content yet. The changes are applied to the output
+ * when the handlers return: content inserted with `append` and `after`,
+ * and the end of removed content, are written when the element is closed.
+ */
+class StreamElement {
+public:
+    /**
+     * @brief Returns the tag id of the element.
+     */
+    [[nodiscard]] TAG tag_id() const;
+
+    /**
+     * @brief Returns the lower case tag name of the element.
+     */
+    [[nodiscard]] std::string_view tag_name() const;
+
+    /**
+     * @brief Returns the value of the attribute `key`.
+     *
+     * @return Optional with the value if the attribute exists,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<std::string_view>
+    attribute(std::string_view key) const;
+
+    /**
+     * @brief Checks if the element has the attribute `key`.
+     */
+    [[nodiscard]] bool has_attribute(std::string_view key) const;
+
+    /**
+     * @brief Returns the keys and values of all attributes.
+     */
+    [[nodiscard]] const std::vector<std::pair<std::string, std::string>>&
+    attributes() const;
+
+    /**
+     * @brief Sets the attribute `key` to `value`, adding it after the
+     *        existing attributes if it is not there yet.
+     *
+     * The start tag of the element is serialized anew.
+     */
+    void set_attribute(std::string_view key, std::string_view value);
+
+    /**
+     * @brief Removes the attribute `key` if it exists.
+     *
+     * The start tag of the element is serialized anew.
+     */
+    void remove_attribute(std::string_view key);
+
+    /**
+     * @brief Writes `html` before the start tag.
+     */
+    void before(std::string_view html);
+
+    /**
+     * @brief Writes `html` after the end tag.
+     */
+    void after(std::string_view html);
+
+    /**
+     * @brief Writes `html` after the start tag, before the content.
+     */
+    void prepend(std::string_view html);
+
+    /**
+     * @brief Writes `html` after the content, before the end tag.
+     */
+    void append(std::string_view html);
+
+    /**
+     * @brief Replaces the content of the element with `html`.
+     */
+    void set_inner_html(std::string_view html);
+
+    /**
+     * @brief Removes the element and its content.
+     *
+     * Content inserted with `before` and `after` is still written.
+     */
+    void remove();
+
+    /**
+     * @brief Checks if the element was removed.
+     */
+    [[nodiscard]] bool removed() const;
+
+private:
+    friend class StreamRewriter;
+
+    StreamElement(TAG tag_id, std::string_view tag_name,
+                  std::vector<std::pair<std::string, std::string>> attributes);
+
+    TAG m_tag_id;
+    std::string m_tag_name;
+    std::vector<std::pair<std::string, std::string>> m_attributes;
+
+    bool m_attributes_changed = false;
+    bool m_removed = false;
+    bool m_inner_replaced = false;
+
+    std::string m_before;
+    std::string m_after;
+    std::string m_prepend;
+    std::string m_append;
+    std::string m_inner_html;
+};
+
+/**
+ * @brief Rewrites HTML while it streams through, without building a Tree.
+ *
+ * Handlers are registered on selectors and called with the StreamElement
+ * of every start tag the selector matches. Input chunks are tokenized by
+ * myhtml as they arrive and the output is written to a sink at the end of
+ * every `write`, so the first bytes leave before the document is complete.
+ *
+ * Instead of a tree, the rewriter keeps the stack of open elements and the
+ * input that has not been written yet, so its memory is bounded by the
+ * nesting depth rather than the size of the document. The stack follows
+ * the end tags and a simplified version of the HTML rules for implied end
+ * tags (`<p>`, `<li>`, `<td>`, ...); documents that rely on the more
+ * complex error recovery of the HTML parser may be matched differently
+ * than by Tree::select.
+ *
+ * Everything that is not changed by a handler is copied from the input
+ * byte for byte.
+ */
+class StreamRewriter {
+public:
+    using Handler = std::function<void(StreamElement&)>;
+
+    /**
+     * @brief StreamRewriter constructor.
+     *
+     * @param sink Receives the rewritten HTML.
+     * @throw init_error, tree_init_error if myhtml can not be initialized.
+     */
+    explicit StreamRewriter(Sink sink);
+
+    /**
+     * @brief StreamRewriter destructor.
+     *
+     * Calls `myhtml_tree_destroy` and `myhtml_destroy`.
+     */
+    ~StreamRewriter();
+
+    StreamRewriter(const StreamRewriter&) = delete;
+    StreamRewriter& operator=(const StreamRewriter&) = delete;
+
+    StreamRewriter(StreamRewriter&&) = delete;
+    StreamRewriter& operator=(StreamRewriter&&) = delete;
+
+    /**
+     * @brief Calls `handler` for every element matching `selector`.
+     *
+     * Handlers are called in the order they were registered.
+     *
+     * @throw std::invalid_argument if `selector` is not streamable.
+     * @see Selector::streamable
+     */
+    void on(Selector selector, Handler handler);
+
+    /**
+     * @brief Calls `handler` for every element matching `selector`.
+     *
+     * @throw selector_error if `selector` is not a valid selector.
+     * @throw std::invalid_argument if `selector` is not streamable.
+     */
+    void on(std::string_view selector, Handler handler);
+
+    /**
+     * @brief Rewrites the next chunk of the input.
+     *
+     * Everything that can be rewritten with the input so far is written to
+     * the sink before `write` returns. A tag or text that is cut off at the
+     * end of the chunk is kept until the next one.
+     *
+     * @throw parse_error if myhtml fails to tokenize the chunk.
+     * @throw std::logic_error if `end` was called before.
+     */
+    void write(std::string_view chunk);
+
+    /**
+     * @brief Finishes the input and writes the rest of the output.
+     *
+     * Elements that are still open are closed, e.g. their `append` and
+     * `after` content is written.
+     *
+     * @throw parse_error if myhtml fails to finish the input.
+     */
+    void end();
+
+    /**
+     * @brief Returns the number of currently open elements.
+     */
+    [[nodiscard]] size_t depth() const;
+
+private:
+    static void* on_token(myhtml_tree_t* tree, myhtml_token_node_t* token,
+                          void* ctx);
+
+    void process(myhtml_token_node_t* token);
+    void start_tag(TAG tag, myhtml_token_node_t* token, size_t begin,
+                   size_t end);
+    void end_tag(TAG tag, size_t begin, size_t end);
+
+    /// Closes the innermost open element, `end` is the offset after its end
+    /// tag, std::nullopt if the end tag is implied.
+    void close(std::optional<size_t> end);
+
+    void push(StreamElement element);
+
+    /// Writes the input up to `offset`, unless it is removed.
+    void copy_to(size_t offset);
+
+    /// Writes `text`, unless it is in removed content.
+    void emit(std::string_view text);
+
+    void flush();
+
+    void check(mystatus_t status);
+
+    Sink m_sink;
+
+    myhtml_t* m_raw_myhtml;
+    myhtml_tree_t* m_raw_tree;
+
+    std::vector<std::pair<Selector, Handler>> m_handlers;
+
+    /// The open elements from the root down.
+    std::vector<StreamElement> m_stack;
+
+    /// The number of open svg and math elements.
+    size_t m_foreign_depth = 0;
+
+    /// The index of the open element whose content is removed or replaced,
+    /// npos if the output is not suppressed.
+    size_t m_suppressed_from;
+
+    /// The input from `m_chunks_offset` on that has not been written yet.
+    std::deque<std::string> m_chunks;
+    size_t m_chunks_offset = 0;
+
+    /// The length of the input so far.
+    size_t m_length = 0;
+
+    /// The offset up to which the input was written or skipped.
+    size_t m_position = 0;
+
+    std::string m_buffer;
+
+    std::exception_ptr m_error;
+    bool m_ended = false;
+};
+
+}  // namespace myhtmlpp
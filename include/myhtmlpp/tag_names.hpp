@@ -0,0 +1,149 @@
+#pragma once
+
+#include "constants.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace myhtmlpp {
+
+namespace detail {
+
+/// The names of the tags in TAG, indexed by id, spelled as myhtml
+/// returns them from `myhtml_tag_name_by_id`.
+inline constexpr std::array<std::string_view,
+                            static_cast<size_t>(TAG::LAST_ENTRY)>
+    tag_names{{
+        "-undef", "-text", "!--", "!doctype", "a", "abbr", "acronym", "address",
+        "annotation-xml", "applet", "area", "article", "aside", "audio", "b",
+        "base", "basefont", "bdi", "bdo", "bgsound", "big", "blink",
+        "blockquote", "body", "br", "button", "canvas", "caption", "center",
+        "cite", "code", "col", "colgroup", "command", "comment", "datalist",
+        "dd", "del", "details", "dfn", "dialog", "dir", "div", "dl", "dt", "em",
+        "embed", "fieldset", "figcaption", "figure", "font", "footer", "form",
+        "frame", "frameset", "h1", "h2", "h3", "h4", "h5", "h6", "head",
+        "header", "hgroup", "hr", "html", "i", "iframe", "image", "img",
+        "input", "ins", "isindex", "kbd", "keygen", "label", "legend", "li",
+        "link", "listing", "main", "map", "mark", "marquee", "menu", "menuitem",
+        "meta", "meter", "mtext", "nav", "nobr", "noembed", "noframes",
+        "noscript", "object", "ol", "optgroup", "option", "output", "p",
+        "param", "plaintext", "pre", "progress", "q", "rb", "rp", "rt", "rtc",
+        "ruby", "s", "samp", "script", "section", "select", "small", "source",
+        "span", "strike", "strong", "style", "sub", "summary", "sup", "svg",
+        "table", "tbody", "td", "template", "textarea", "tfoot", "th", "thead",
+        "time", "title", "tr", "track", "tt", "u", "ul", "var", "video", "wbr",
+        "xmp", "altglyph", "altglyphdef", "altglyphitem", "animate",
+        "animatecolor", "animatemotion", "animatetransform", "circle",
+        "clippath", "color-profile", "cursor", "defs", "desc", "ellipse",
+        "feblend", "fecolormatrix", "fecomponenttransfer", "fecomposite",
+        "feconvolvematrix", "fediffuselighting", "fedisplacementmap",
+        "fedistantlight", "fedropshadow", "feflood", "fefunca", "fefuncb",
+        "fefuncg", "fefuncr", "fegaussianblur", "feimage", "femerge",
+        "femergenode", "femorphology", "feoffset", "fepointlight",
+        "fespecularlighting", "fespotlight", "fetile", "feturbulence", "filter",
+        "font-face", "font-face-format", "font-face-name", "font-face-src",
+        "font-face-uri", "foreignobject", "g", "glyph", "glyphref", "hkern",
+        "line", "lineargradient", "marker", "mask", "metadata", "missing-glyph",
+        "mpath", "path", "pattern", "polygon", "polyline", "radialgradient",
+        "rect", "set", "stop", "switch", "symbol", "text", "textpath", "tref",
+        "tspan", "use", "view", "vkern", "math", "maction", "maligngroup",
+        "malignmark", "menclose", "merror", "mfenced", "mfrac", "mglyph", "mi",
+        "mlabeledtr", "mlongdiv", "mmultiscripts", "mn", "mo", "mover",
+        "mpadded", "mphantom", "mroot", "mrow", "ms", "mscarries", "mscarry",
+        "msgroup", "msline", "mspace", "msqrt", "msrow", "mstack", "mstyle",
+        "msub", "msup", "msubsup", "-end-of-file"}};
+
+/// Slots of the tag name hash table.
+inline constexpr size_t tag_hash_size = 4096;
+
+/// The seed of the tag name hash, chosen so that all names in
+/// `tag_names` land in different slots.
+inline constexpr uint32_t tag_hash_seed = 72;
+
+/// Marks an empty slot of the tag name hash table.
+inline constexpr uint8_t tag_hash_empty = 0xff;
+
+static_assert(static_cast<size_t>(TAG::LAST_ENTRY) < tag_hash_empty,
+              "tag ids must fit into the slots of the hash table");
+
+// FNV-1a folded to an index of the hash table.
+constexpr size_t tag_hash(std::string_view name) {
+    uint32_t hash = tag_hash_seed;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619U;
+    }
+
+    return (hash ^ (hash >> 16U)) & (tag_hash_size - 1);
+}
+
+constexpr std::array<uint8_t, tag_hash_size> make_tag_hash_table() {
+    std::array<uint8_t, tag_hash_size> table{};
+    for (auto& slot : table) {
+        slot = tag_hash_empty;
+    }
+
+    for (size_t id = 0; id < tag_names.size(); ++id) {
+        table[tag_hash(tag_names[id])] = static_cast<uint8_t>(id);
+    }
+
+    return table;
+}
+
+/// Maps the hash of a tag name to its id, tag_hash_empty if no name has
+/// that hash.
+inline constexpr std::array<uint8_t, tag_hash_size> tag_hash_table =
+    make_tag_hash_table();
+
+constexpr bool tag_hash_is_perfect() {
+    for (size_t id = 0; id < tag_names.size(); ++id) {
+        if (tag_hash_table[tag_hash(tag_names[id])] != id) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static_assert(tag_hash_is_perfect(),
+              "tag names collide in the hash table, choose another seed");
+
+}  // namespace detail
+
+/**
+ * @brief Returns the name of the tag `tag_id`.
+ *
+ * The name is the one `Node::tag_name` returns, e.g. "div",
+ * "annotation-xml" or "-text", looked up without a tree.
+ *
+ * @return The lower case name, an empty string_view for ids of custom
+ *         tags, which are only known to the tree that created them.
+ */
+[[nodiscard]] constexpr std::string_view tag_name(TAG tag_id) {
+    auto index = static_cast<size_t>(tag_id);
+    return index < detail::tag_names.size() ? detail::tag_names[index]
+                                            : std::string_view();
+}
+
+/**
+ * @brief Returns the id of the tag named `name`.
+ *
+ * Looked up in a perfect hash table that is built at compile time, so
+ * finding a name costs one hash and one string comparison. Like the
+ * names of nodes, the lookup is case sensitive.
+ *
+ * @param name The lower case name of the tag, e.g. "div".
+ * @return The id, TAG::UNDEF_ if `name` is not the name of a tag in TAG,
+ *         e.g. for custom tags.
+ */
+[[nodiscard]] constexpr TAG tag_from_name(std::string_view name) {
+    uint8_t id = detail::tag_hash_table[detail::tag_hash(name)];
+    if (id == detail::tag_hash_empty || detail::tag_names[id] != name) {
+        return TAG::UNDEF_;
+    }
+
+    return static_cast<TAG>(id);
+}
+
+}  // namespace myhtmlpp
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "constants.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// Options for Node::visible_text.
+struct VisibleTextOptions {
+    /// Elements whose subtrees are skipped entirely.
+    std::vector<TAG> skip_tags{TAG::SCRIPT, TAG::STYLE, TAG::NOSCRIPT,
+                               TAG::TEMPLATE};
+
+    /// Put the text of block elements (p, div, li, ...) on separate lines
+    /// and turn `<br>` into a line break.
+    bool block_newlines = true;
+
+    /// Collapse runs of whitespace into a single space and drop whitespace
+    /// at the start and end of lines. The text inside of `<pre>`,
+    /// `<textarea>`, `<listing>` and `<plaintext>` is kept as is.
+    bool collapse_whitespace = true;
+};
+
+/// Options for append_normalized.
+struct NormalizeOptions {
+    /// Replace every run of whitespace with a single space.
+    bool collapse_whitespace = true;
+
+    /// Drop whitespace at the start and the end of the text.
+    bool trim = true;
+
+    /// Treat U+00A0 (no-break space, `&nbsp;` in HTML) as whitespace and
+    /// write it as a plain space.
+    bool nbsp_to_space = true;
+};
+
+/**
+ * @brief Appends the normalized `text` to `out`.
+ *
+ * Whitespace is space, tab, line feed, carriage return and form feed, and
+ * the no-break space if `options.nbsp_to_space` is set. Entities are
+ * decoded by the parser already, so `&nbsp;` arrives as U+00A0 in UTF-8.
+ *
+ * When whitespace is collapsed, whitespace at the start of `text` is also
+ * dropped if `out` is empty or ends with whitespace. Without `trim`,
+ * appending the text of several nodes one after the other gives the same
+ * result as normalizing their concatenation.
+ *
+ * The text is classified 16 or 32 bytes at a time with SSE2 or AVX2,
+ * depending on the CPU, and copied into `out` in the same pass; other
+ * platforms use a scalar loop.
+ *
+ * @param out The string the normalized text is appended to.
+ * @param text UTF-8 text, e.g. from Node::text_view.
+ * @param options How to normalize the text.
+ */
+void append_normalized(std::string& out, std::string_view text,
+                       const NormalizeOptions& options = {});
+
+/**
+ * @brief Returns the normalized `text`.
+ *
+ * @see append_normalized
+ */
+[[nodiscard]] std::string normalize_text(std::string_view text,
+                                         const NormalizeOptions& options = {});
+
+/**
+ * @brief Finds the first occurrence of `needle` in `haystack` at or after
+ *        `pos`.
+ *
+ * Candidate positions are found by comparing the first and the last byte
+ * of `needle` against 16 or 32 positions at once with SSE2 or AVX2,
+ * depending on the CPU, only the candidates are compared in full.
+ *
+ * @return The position of the occurrence, std::string_view::npos if there
+ *         is none.
+ */
+[[nodiscard]] size_t find_substring(std::string_view haystack,
+                                    std::string_view needle, size_t pos = 0);
+
+}  // namespace myhtmlpp
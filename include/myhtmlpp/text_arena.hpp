@@ -0,0 +1,114 @@
+#pragma once
+
+#include "node.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <myhtml/myhtml.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/**
+ * @brief The text of all text nodes of a (sub)tree in one contiguous buffer.
+ *
+ * The text nodes are copied in document order without separators, so a
+ * search over `text()` also finds matches that span several text nodes,
+ * e.g. `<b>fo</b>o`. Byte offsets into `text()` map back to the text nodes
+ * with `node_at` and `nodes_in`.
+ *
+ * Offsets are 32 bit, so the text of an arena is limited to 4 GiB.
+ *
+ * A TextArena does not change when the Tree changes. The Node handles it
+ * returns are only valid as long as the Tree is alive.
+ */
+class TextArena {
+public:
+    /**
+     * @brief TextArena constructor.
+     *
+     * Copies the text of all text nodes in the subtree of `root` (including
+     * `root` itself).
+     *
+     * @param root The root node of the arena.
+     */
+    explicit TextArena(const Node& root);
+
+    /**
+     * @brief Returns the root node of the arena.
+     */
+    [[nodiscard]] Node root() const;
+
+    /**
+     * @brief Returns the joined text of all text nodes.
+     */
+    [[nodiscard]] std::string_view text() const;
+
+    /**
+     * @brief Returns the number of text nodes.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Returns the `i`-th text node in document order.
+     */
+    [[nodiscard]] Node node(size_t i) const;
+
+    /**
+     * @brief Returns the offset of the text of the `i`-th text node.
+     */
+    [[nodiscard]] size_t offset(size_t i) const;
+
+    /**
+     * @brief Returns the text of the `i`-th text node.
+     */
+    [[nodiscard]] std::string_view text(size_t i) const;
+
+    /**
+     * @brief Returns the index of the text node that contains the byte at
+     *        `offset`.
+     *
+     * @return Optional with the index if `offset < text().size()`,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<size_t> index_at(size_t offset) const;
+
+    /**
+     * @brief Returns the text node that contains the byte at `offset`.
+     *
+     * @return Optional with the node if `offset < text().size()`,
+     *         std::nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<Node> node_at(size_t offset) const;
+
+    /**
+     * @brief Returns the text nodes that overlap the byte range
+     *        `[begin, end)` in document order, e.g. all nodes of a match.
+     */
+    [[nodiscard]] std::vector<Node> nodes_in(size_t begin, size_t end) const;
+
+    /**
+     * @brief Returns the deepest elements that contain the text `needle`.
+     *
+     * Same as `Tree::find_text(needle, root(), TEXT_SEARCH::ELEMENTS)`,
+     * but searches the text of this arena instead of copying it again, so
+     * one arena serves many searches.
+     *
+     * @return A vector of the matching elements in the order of their
+     *         first match, empty for an empty needle.
+     */
+    [[nodiscard]] std::vector<Node>
+    find_elements(std::string_view needle) const;
+
+private:
+    myhtml_tree_node_t* m_root;
+    /// The text of node `i` is `m_text[m_offsets[i], m_offsets[i + 1])`.
+    std::vector<uint32_t> m_offsets;
+    std::vector<myhtml_tree_node_t*> m_nodes;
+    std::string m_text;
+};
+
+}  // namespace myhtmlpp
@@ -1,18 +1,41 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "constants.hpp"
 #include "filter.hpp"
 #include "node.hpp"
-
+#include "result.hpp"
+#include "selector.hpp"
+#include "serialization.hpp"
+#include "snapshot.hpp"
+#include "static_selector.hpp"
+#include "text.hpp"
+#include "text_arena.hpp"
+
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <mycore/myosi.h>
 #include <myhtml/myhtml.h>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace myhtmlpp {
 
-/// A HTML Tree class
+class TreeInfo;
+
+/**
+ * @brief A HTML Tree class.
+ *
+ * Thread safety: the const member functions of Tree, Node and Attribute only
+ * read the underlying myhtml structures, so any number of threads may query
+ * the same Tree concurrently (including `select`, which creates its own
+ * mycss instances per call), as long as no thread moves, destroys or
+ * otherwise modifies the Tree at the same time.
+ */
 class Tree {
 public:
     /**
@@ -53,6 +76,27 @@ public:
      */
     [[nodiscard]] Node document_node() const;
 
+    /**
+     * @brief Returns the source the tree was parsed from.
+     *
+     * If the tree was parsed with ParseOptions::keep_source, the tree owns
+     * a copy of the source and the view is valid as long as the Tree is
+     * alive. Otherwise it points into the string passed to the parser and
+     * must not be used after that string was destroyed or modified.
+     *
+     * @return A view of the source, an empty view if the tree was not
+     *         parsed from a single string.
+     * @see Node::source_range
+     */
+    [[nodiscard]] std::string_view source() const;
+
+    /**
+     * @brief Returns the encoding the source was decoded from.
+     *
+     * @see ParseOptions::encoding
+     */
+    [[nodiscard]] ENCODING encoding() const;
+
     /**
      * @brief Returns the html node of the tree.
      *
@@ -81,18 +125,173 @@ public:
      */
     [[nodiscard]] std::string html() const;
 
+    /**
+     * @brief Writes a HTML representation of the tree to `sink`.
+     *
+     * @throw serialization_error if myhtml fails to serialize the tree.
+     * @see Tree::html
+     */
+    void write_html(const Sink& sink) const;
+
+    /**
+     * @brief Returns the HTML representation of the tree serialized with
+     *        `options`.
+     *
+     * @see SerializeOptions
+     */
+    [[nodiscard]] std::string html(const SerializeOptions& options) const;
+
+    /**
+     * @brief Writes a HTML representation of the tree serialized with
+     *        `options` to `sink`.
+     *
+     * @throw serialization_error if myhtml fails to serialize the tree.
+     * @see SerializeOptions
+     */
+    void write_html(const Sink& sink, const SerializeOptions& options) const;
+
+    /**
+     * @brief Numbers all nodes in pre- and post-order.
+     *
+     * While the numbering exists, `Node::is_ancestor_of`,
+     * `Node::document_position`, `Node::subtree_size` and `DocumentOrder`
+     * take constant time instead of walking parent chains. The numbering is
+     * built in one pass over the tree and is dropped automatically when
+     * nodes are inserted into or removed from the tree; call this method
+     * again afterwards to rebuild it.
+     *
+     * The numbers are attached to the nodes through the myhtml node data
+     * pointer (`myhtml_node_set_data`), which must not be used otherwise
+     * while the numbering exists. Building or clearing the numbering must
+     * not happen concurrently with other operations on the tree.
+     */
+    void build_order_index();
+
+    /**
+     * @brief Removes the numbering created by `build_order_index`.
+     */
+    void clear_order_index();
+
+    /**
+     * @brief Checks if the nodes of the tree are currently numbered.
+     *
+     * @return true if `build_order_index` was called and the tree was not
+     *         modified afterwards, false otherwise.
+     */
+    [[nodiscard]] bool has_order_index() const;
+
+    /**
+     * @brief Returns a flattened copy of the tree for fast scans.
+     *
+     * @return A Snapshot of all nodes in the tree.
+     *
+     * @see Snapshot
+     */
+    [[nodiscard]] Snapshot snapshot() const;
+
+    /**
+     * @brief Returns a flattened copy of the subtree of `scope_node`.
+     *
+     * @return A Snapshot of `scope_node` and all of its descendants.
+     */
+    [[nodiscard]] Snapshot snapshot(const Node& scope_node) const;
+
+    /**
+     * @brief Returns the text of all text nodes in one buffer.
+     *
+     * @return A TextArena with the text of all text nodes in the tree.
+     *
+     * @see TextArena
+     */
+    [[nodiscard]] TextArena text_arena() const;
+
+    /**
+     * @brief Returns the text of all text nodes in the subtree of
+     *        `scope_node` in one buffer.
+     */
+    [[nodiscard]] TextArena text_arena(const Node& scope_node) const;
+
     /**
      * @brief Returns all nodes in the tree that match the css selector
      * `selector`.
      *
      * @param selector The css selector.
      * @return A vector of all nodes in the tree that match `selector`.
+     * @throw selector_error if `selector` is not a valid selector.
      */
     [[nodiscard]] std::vector<Node> select(const std::string& selector) const;
 
+    /**
+     * @brief Returns all nodes in the tree that match the css selector
+     *        `selector`, without throwing if it is not valid.
+     *
+     * @param selector The css selector.
+     * @return A vector of all nodes in the tree that match `selector`, or
+     *         the status of the failure, see Selector::try_create.
+     */
+    [[nodiscard]] Result<std::vector<Node>, mystatus_t>
+    try_select(const std::string& selector) const;
+
+    /**
+     * @brief Returns all nodes in the tree that match the parsed selector
+     *        `selector`.
+     *
+     * Unlike the string overload, the selector is not parsed again on every
+     * call.
+     *
+     * @param selector The parsed css selector.
+     * @return A vector of all nodes in the tree that match `selector`.
+     */
+    [[nodiscard]] std::vector<Node> select(const Selector& selector) const;
+
+    /**
+     * @brief Returns all nodes in the tree that match the compiled selector
+     *        `selector`.
+     *
+     * A compiled selector is matched while walking the tree, comparing tag
+     * ids and looking up its attribute keys directly; otherwise its text is
+     * parsed with mycss like in the string overload.
+     *
+     * @param selector The selector, e.g. `"div.item > a[href]"_sel`.
+     * @return A vector of all nodes in the tree that match `selector`, in
+     *         document order if `selector` is compiled.
+     * @throw selector_error if `selector` is not compiled and mycss can not
+     *        parse it.
+     * @see StaticSelector::compiled
+     */
+    [[nodiscard]] std::vector<Node>
+    select(const StaticSelector& selector) const;
+
+    /**
+     * @brief Returns all nodes in the tree that match `selector`, giving up
+     *        when `token` is cancelled.
+     *
+     * Streamable and compiled selectors are matched while walking the tree
+     * and `token` is checked every few hundred nodes, the matches are
+     * returned in document order. Other selectors are matched by mycss in
+     * one call and `token` is only checked before it.
+     *
+     * @throw cancelled_error if `token` is cancelled before all nodes were
+     *        matched.
+     * @throw selector_error if `selector` is not a valid selector.
+     * @see Selector::streamable
+     */
+    [[nodiscard]] std::vector<Node>
+    select(const std::string& selector, const CancellationToken& token) const;
+
+    [[nodiscard]] std::vector<Node>
+    select(const Selector& selector, const CancellationToken& token) const;
+
+    [[nodiscard]] std::vector<Node>
+    select(const StaticSelector& selector,
+           const CancellationToken& token) const;
+
     /**
      * @brief Returns all nodes in the tree where the tag matches `tag`.
      *
+     * Names of tags in TAG are resolved to their id once with
+     * `tag_from_name`, so only custom tags are compared by name.
+     *
      * @param tag The tag to search.
      * @return A vector of all nodes in the tree where
      *         `tag_name()` returns `tag`.
@@ -101,6 +300,19 @@ public:
 
     [[nodiscard]] std::vector<Node> find_by_tag(const std::string& tag,
                                                 const Node& scope_node) const;
+
+    /**
+     * @brief Returns all nodes in the tree where the tag matches `tag`,
+     *        giving up when `token` is cancelled.
+     *
+     * The find_by_* overloads taking a CancellationToken check it every few
+     * hundred nodes.
+     *
+     * @throw cancelled_error if `token` is cancelled before the whole tree
+     *        was searched.
+     */
+    [[nodiscard]] std::vector<Node>
+    find_by_tag(const std::string& tag, const CancellationToken& token) const;
     /**
      * @brief Returns all nodes in the tree where the tag matches `tag`.
      *
@@ -113,6 +325,9 @@ public:
     [[nodiscard]] std::vector<Node> find_by_tag(TAG tag,
                                                 const Node& scope_node) const;
 
+    [[nodiscard]] std::vector<Node>
+    find_by_tag(TAG tag, const CancellationToken& token) const;
+
     /**
      * @brief Returns all nodes in the tree where the class matches `cl`.
      *
@@ -125,6 +340,9 @@ public:
     [[nodiscard]] std::vector<Node> find_by_class(const std::string& cl,
                                                   const Node& scope_node) const;
 
+    [[nodiscard]] std::vector<Node>
+    find_by_class(const std::string& cl, const CancellationToken& token) const;
+
     /**
      * @brief Returns all nodes in the tree where the id matches `id`.
      *
@@ -137,6 +355,9 @@ public:
     [[nodiscard]] std::vector<Node> find_by_id(const std::string& id,
                                                const Node& scope_node) const;
 
+    [[nodiscard]] std::vector<Node>
+    find_by_id(const std::string& id, const CancellationToken& token) const;
+
     /**
      * @brief Returns all nodes in the tree that have an attribute with key
      * `key` and value `value`.
@@ -153,6 +374,33 @@ public:
                                                  const std::string& val,
                                                  const Node& scope_node) const;
 
+    [[nodiscard]] std::vector<Node>
+    find_by_attr(const std::string& key, const std::string& val,
+                 const CancellationToken& token) const;
+
+    /**
+     * @brief Returns all nodes in the tree that contain the text `needle`.
+     *
+     * The text is searched with find_substring instead of building the
+     * inner text of every candidate element. With TEXT_SEARCH::ELEMENTS,
+     * the text of the tree is copied once into a TextArena and every match
+     * is mapped back to the deepest element that contains all of it; use
+     * TextArena::find_elements to search one copy for several needles.
+     *
+     * @param needle The literal text to search for, nothing matches an
+     *        empty needle.
+     * @param mode Whether to return text nodes or elements.
+     * @return A vector of the matching text nodes in document order, or of
+     *         the matching elements in the order of their first match.
+     */
+    [[nodiscard]] std::vector<Node>
+    find_text(std::string_view needle,
+              TEXT_SEARCH mode = TEXT_SEARCH::TEXT_NODES) const;
+
+    [[nodiscard]] std::vector<Node>
+    find_text(std::string_view needle, const Node& scope_node,
+              TEXT_SEARCH mode = TEXT_SEARCH::TEXT_NODES) const;
+
     /**
      * @brief Returns all nodes in the tree where `f` returns true.
      *
@@ -164,6 +412,92 @@ public:
         return Filter(*this, f);
     }
 
+    /**
+     * @brief Returns all nodes in the tree where `f` returns true, giving
+     *        up when `token` is cancelled.
+     *
+     * Unlike the lazy overload, the whole tree is searched at once and
+     * `token` is checked every few hundred nodes.
+     *
+     * @param f The filter function.
+     * @param token Cancels the search.
+     * @return A vector of all nodes in the tree where `f` returns true.
+     * @throw cancelled_error if `token` is cancelled before the whole tree
+     *        was searched.
+     */
+    template <typename FilterFunc>
+    [[nodiscard]] std::vector<Node>
+    filter(FilterFunc f, const CancellationToken& token) const {
+        return collect(std::function<bool(const Node&)>(f), token);
+    }
+
+    /**
+     * @brief Returns all nodes in the tree where `f` returns true,
+     *        evaluating `f` concurrently on the library thread pool.
+     *
+     * The tree is split into disjoint subtrees which are searched in
+     * parallel; the results are merged back into document order, so the
+     * result equals `filter(f).to_vector()`. `f` is called from several
+     * threads at the same time and must be safe to do so. If `f` throws,
+     * the remaining work is skipped and the first exception is rethrown on
+     * the calling thread once all workers are done with `f`.
+     *
+     * @param f The filter function.
+     * @param thread_count The maximum number of threads to use,
+     *        0 uses all threads of the pool.
+     * @return A vector of all nodes in the tree where `f` returns true.
+     */
+    template <typename FilterFunc>
+    [[nodiscard]] std::vector<Node>
+    parallel_filter(FilterFunc f, size_t thread_count = 0) const {
+        return parallel_filter(f, document_node(), thread_count);
+    }
+
+    template <typename FilterFunc>
+    [[nodiscard]] std::vector<Node>
+    parallel_filter(FilterFunc f, const Node& scope_node,
+                    size_t thread_count = 0) const {
+        return parallel_collect(scope_node, std::function<bool(const Node&)>(f),
+                                thread_count);
+    }
+
+    /**
+     * @brief Parallel version of `find_by_tag`.
+     *
+     * @see Tree::parallel_filter
+     */
+    [[nodiscard]] std::vector<Node>
+    parallel_find_by_tag(const std::string& tag, size_t thread_count = 0) const;
+
+    [[nodiscard]] std::vector<Node>
+    parallel_find_by_tag(TAG tag, size_t thread_count = 0) const;
+
+    /**
+     * @brief Parallel version of `find_by_class`.
+     *
+     * @see Tree::parallel_filter
+     */
+    [[nodiscard]] std::vector<Node>
+    parallel_find_by_class(const std::string& cl,
+                           size_t thread_count = 0) const;
+
+    /**
+     * @brief Parallel version of `find_by_id`.
+     *
+     * @see Tree::parallel_filter
+     */
+    [[nodiscard]] std::vector<Node>
+    parallel_find_by_id(const std::string& id, size_t thread_count = 0) const;
+
+    /**
+     * @brief Parallel version of `find_by_attr`.
+     *
+     * @see Tree::parallel_filter
+     */
+    [[nodiscard]] std::vector<Node>
+    parallel_find_by_attr(const std::string& key, const std::string& val,
+                          size_t thread_count = 0) const;
+
     /// A Tree Iterator class.
     class Iterator {
     public:
@@ -256,11 +590,30 @@ public:
     [[nodiscard]] ConstIterator cend() const noexcept;
 
 private:
+    /// Gives the library internals access to the myhtml pointers.
+    friend struct RawAccess;
+
+    /// Searches the subtree of `scope_node` for nodes where `f` returns true
+    /// on up to `thread_count` threads.
+    [[nodiscard]] std::vector<Node>
+    parallel_collect(const Node& scope_node,
+                     const std::function<bool(const Node&)>& f,
+                     size_t thread_count) const;
+
+    /// Searches the tree for nodes where `f` returns true, checking `token`
+    /// every few hundred nodes.
+    [[nodiscard]] std::vector<Node>
+    collect(const std::function<bool(const Node&)>& f,
+            const CancellationToken& token) const;
+
     /// Pointer to the underlying myhtml struct.
     myhtml_t* m_raw_myhtml;
 
     /// Pointer to the underlying myhtml tree struct.
     myhtml_tree_t* m_raw_tree;
+
+    /// State the library keeps next to the myhtml tree.
+    std::unique_ptr<TreeInfo> m_info;
 };
 
 /**
@@ -6,6 +6,7 @@
 #include <myhtml/tree.h>
 #include <optional>
 #include <string>
+#include <string_view>
 
 myhtmlpp::Attribute::Attribute(myhtml_tree_attr_t* raw_attribute)
     : m_raw_attribute(raw_attribute) {}
@@ -35,19 +36,37 @@ bool myhtmlpp::Attribute::operator!=(const Attribute& other) const {
 bool myhtmlpp::Attribute::good() const { return m_raw_attribute != nullptr; }
 
 std::string myhtmlpp::Attribute::key() const {
-    if (auto k = myhtml_attribute_key(m_raw_attribute, nullptr)) {
-        return k;
+    return std::string(key_view());
+}
+
+std::string myhtmlpp::Attribute::value() const {
+    return std::string(value_view());
+}
+
+std::string_view myhtmlpp::Attribute::key_view() const {
+    if (m_raw_attribute == nullptr) {
+        return {};
     }
 
-    return "";
+    size_t length = 0;
+    if (auto k = myhtml_attribute_key(m_raw_attribute, &length)) {
+        return std::string_view(k, length);
+    }
+
+    return {};
 }
 
-std::string myhtmlpp::Attribute::value() const {
-    if (auto k = myhtml_attribute_value(m_raw_attribute, nullptr)) {
-        return k;
+std::string_view myhtmlpp::Attribute::value_view() const {
+    if (m_raw_attribute == nullptr) {
+        return {};
+    }
+
+    size_t length = 0;
+    if (auto v = myhtml_attribute_value(m_raw_attribute, &length)) {
+        return std::string_view(v, length);
     }
 
-    return "";
+    return {};
 }
 
 myhtmlpp::NAMESPACE myhtmlpp::Attribute::get_namespace() const {
@@ -64,8 +83,7 @@ std::optional<myhtmlpp::Attribute> myhtmlpp::Attribute::next() const {
 
 std::ostream& myhtmlpp::operator<<(std::ostream& os,
                                    const myhtmlpp::Attribute& attr) {
-    std::string res = attr.key() + "=\"" + attr.value() + "\"";
-    os << res;
+    os << attr.key_view() << "=\"" << attr.value_view() << "\"";
 
     return os;
 }
@@ -0,0 +1,42 @@
+#include "myhtmlpp/cancellation.hpp"
+
+#include "myhtmlpp/error.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+myhtmlpp::CancellationToken::CancellationToken()
+    : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+myhtmlpp::CancellationToken::CancellationToken(clock::time_point deadline)
+    : m_cancelled(std::make_shared<std::atomic<bool>>(false)),
+      m_deadline(deadline) {}
+
+myhtmlpp::CancellationToken
+myhtmlpp::CancellationToken::after(clock::duration timeout) {
+    return CancellationToken(clock::now() + timeout);
+}
+
+void myhtmlpp::CancellationToken::cancel() {
+    m_cancelled->store(true, std::memory_order_relaxed);
+}
+
+bool myhtmlpp::CancellationToken::cancelled() const {
+    if (m_cancelled->load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    return m_deadline && clock::now() >= *m_deadline;
+}
+
+std::optional<myhtmlpp::CancellationToken::clock::time_point>
+myhtmlpp::CancellationToken::deadline() const {
+    return m_deadline;
+}
+
+void myhtmlpp::CancellationToken::check() const {
+    if (cancelled()) {
+        throw cancelled_error();
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "myhtmlpp/constants.hpp"
+
+namespace myhtmlpp {
+
+// nodes that are elements, not text, comments or the doctype.
+inline bool is_element(TAG tag) {
+    switch (tag) {
+        case TAG::UNDEF_:
+        case TAG::TEXT_:
+        case TAG::COMMENT_:
+        case TAG::DOCTYPE_:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// elements that are rendered as blocks by default.
+inline bool is_block_element(TAG tag) {
+    switch (tag) {
+        case TAG::ADDRESS:
+        case TAG::ARTICLE:
+        case TAG::ASIDE:
+        case TAG::BLOCKQUOTE:
+        case TAG::CAPTION:
+        case TAG::CENTER:
+        case TAG::DD:
+        case TAG::DETAILS:
+        case TAG::DIALOG:
+        case TAG::DIR:
+        case TAG::DIV:
+        case TAG::DL:
+        case TAG::DT:
+        case TAG::FIELDSET:
+        case TAG::FIGCAPTION:
+        case TAG::FIGURE:
+        case TAG::FOOTER:
+        case TAG::FORM:
+        case TAG::H1:
+        case TAG::H2:
+        case TAG::H3:
+        case TAG::H4:
+        case TAG::H5:
+        case TAG::H6:
+        case TAG::HEADER:
+        case TAG::HGROUP:
+        case TAG::HR:
+        case TAG::LEGEND:
+        case TAG::LI:
+        case TAG::LISTING:
+        case TAG::MAIN:
+        case TAG::MENU:
+        case TAG::NAV:
+        case TAG::OL:
+        case TAG::OPTION:
+        case TAG::P:
+        case TAG::PLAINTEXT:
+        case TAG::PRE:
+        case TAG::SECTION:
+        case TAG::SUMMARY:
+        case TAG::TABLE:
+        case TAG::TBODY:
+        case TAG::TEXTAREA:
+        case TAG::TFOOT:
+        case TAG::THEAD:
+        case TAG::TITLE:
+        case TAG::TR:
+        case TAG::UL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// elements whose whitespace is significant.
+inline bool is_preformatted(TAG tag) {
+    return tag == TAG::PRE || tag == TAG::TEXTAREA || tag == TAG::LISTING ||
+           tag == TAG::PLAINTEXT;
+}
+
+// elements whose text is serialized without escaping.
+inline bool is_raw_text(TAG tag) {
+    return tag == TAG::SCRIPT || tag == TAG::STYLE || tag == TAG::XMP ||
+           tag == TAG::IFRAME || tag == TAG::NOEMBED ||
+           tag == TAG::NOFRAMES || tag == TAG::PLAINTEXT;
+}
+
+// elements whose start tag closes an open <p>, so the end tag of the <p>
+// may be omitted before them.
+inline bool closes_paragraph(TAG tag) {
+    switch (tag) {
+        case TAG::ADDRESS:
+        case TAG::ARTICLE:
+        case TAG::ASIDE:
+        case TAG::BLOCKQUOTE:
+        case TAG::DETAILS:
+        case TAG::DIV:
+        case TAG::DL:
+        case TAG::FIELDSET:
+        case TAG::FIGCAPTION:
+        case TAG::FIGURE:
+        case TAG::FOOTER:
+        case TAG::FORM:
+        case TAG::H1:
+        case TAG::H2:
+        case TAG::H3:
+        case TAG::H4:
+        case TAG::H5:
+        case TAG::H6:
+        case TAG::HEADER:
+        case TAG::HGROUP:
+        case TAG::HR:
+        case TAG::MAIN:
+        case TAG::MENU:
+        case TAG::NAV:
+        case TAG::OL:
+        case TAG::P:
+        case TAG::PRE:
+        case TAG::SECTION:
+        case TAG::TABLE:
+        case TAG::UL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// elements that have no content and no end tag.
+inline bool is_void_element(TAG tag) {
+    switch (tag) {
+        case TAG::AREA:
+        case TAG::BASE:
+        case TAG::BASEFONT:
+        case TAG::BGSOUND:
+        case TAG::BR:
+        case TAG::COL:
+        case TAG::EMBED:
+        case TAG::FRAME:
+        case TAG::HR:
+        case TAG::IMG:
+        case TAG::INPUT:
+        case TAG::KEYGEN:
+        case TAG::LINK:
+        case TAG::META:
+        case TAG::PARAM:
+        case TAG::SOURCE:
+        case TAG::TRACK:
+        case TAG::WBR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace myhtmlpp
@@ -0,0 +1,58 @@
+#include "engine_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <mycore/myosi.h>
+#include <myhtml/myhtml.h>
+#include <thread>
+
+myhtmlpp::EnginePool::EnginePool(size_t max_idle) : m_max_idle(max_idle) {}
+
+myhtmlpp::EnginePool::~EnginePool() {
+    for (myhtml_t* raw_myhtml : m_idle) {
+        myhtml_destroy(raw_myhtml);
+    }
+}
+
+myhtml_t* myhtmlpp::EnginePool::acquire(mystatus_t& status) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            myhtml_t* raw_myhtml = m_idle.back();
+            m_idle.pop_back();
+
+            return raw_myhtml;
+        }
+    }
+
+    myhtml_t* raw_myhtml = myhtml_create();
+    status =
+        myhtml_init(raw_myhtml, MyHTML_OPTIONS_PARSE_MODE_SINGLE, 1, 4096);
+    if (status != MyHTML_STATUS_OK) {
+        myhtml_destroy(raw_myhtml);
+        return nullptr;
+    }
+
+    return raw_myhtml;
+}
+
+void myhtmlpp::EnginePool::release(myhtml_t* raw_myhtml) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_idle.size() < m_max_idle) {
+            m_idle.push_back(raw_myhtml);
+            return;
+        }
+    }
+
+    myhtml_destroy(raw_myhtml);
+}
+
+myhtmlpp::EnginePool& myhtmlpp::EnginePool::shared() {
+    // leaked on purpose, see the documentation
+    static auto* pool = new EnginePool(
+        std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    return *pool;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <mycore/myosi.h>
+#include <myhtml/myhtml.h>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// myhtml instances in single mode that are handed to one parse at a time
+/// and reused after the Tree of that parse is destroyed, so a parse does
+/// not initialize a new instance for every document.
+class EnginePool {
+public:
+    /**
+     * @brief EnginePool constructor.
+     *
+     * @param max_idle The number of released instances that are kept,
+     *        further instances are destroyed when they are released.
+     */
+    explicit EnginePool(size_t max_idle);
+
+    /**
+     * @brief EnginePool destructor.
+     *
+     * Destroys the idle instances, instances still in use are not owned by
+     * the pool.
+     */
+    ~EnginePool();
+
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    EnginePool(EnginePool&&) = delete;
+    EnginePool& operator=(EnginePool&&) = delete;
+
+    /**
+     * @brief Returns an idle instance, or a new one if there is none.
+     *
+     * @param status Set to the status of `myhtml_init` if a new instance
+     *        can not be initialized.
+     * @return The instance, nullptr if it can not be initialized.
+     */
+    [[nodiscard]] myhtml_t* acquire(mystatus_t& status);
+
+    /**
+     * @brief Returns `raw_myhtml` to the pool, no tree may use it anymore.
+     */
+    void release(myhtml_t* raw_myhtml);
+
+    /**
+     * @brief Returns the pool shared by the library.
+     *
+     * The pool keeps up to one idle instance per hardware thread. It is
+     * never destroyed, so trees may release their instance during static
+     * destruction.
+     */
+    static EnginePool& shared();
+
+private:
+    std::vector<myhtml_t*> m_idle;
+    size_t m_max_idle;
+    std::mutex m_mutex;
+};
+
+}  // namespace myhtmlpp
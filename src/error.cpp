@@ -2,6 +2,28 @@
 
 #include <mycore/myosi.h>
 #include <string>
+#include <string_view>
+
+namespace {
+
+const char* limit_name(myhtmlpp::LIMIT limit) {
+    switch (limit) {
+        case myhtmlpp::LIMIT::INPUT_SIZE:
+            return "input size";
+        case myhtmlpp::LIMIT::DEPTH:
+            return "depth";
+        case myhtmlpp::LIMIT::NODES:
+            return "node count";
+        case myhtmlpp::LIMIT::ATTRIBUTES:
+            return "attribute count";
+        case myhtmlpp::LIMIT::TREE_MEMORY:
+            return "tree memory";
+    }
+
+    return "unknown";
+}
+
+}  // namespace
 
 myhtmlpp::myhtml_error::myhtml_error(mystatus_t status, const char* what)
     : m_status(status), m_error(what) {}
@@ -26,3 +48,25 @@ myhtmlpp::parse_error::parse_error(mystatus_t status)
     : myhtml_error(
           status,
           ("parsing failed with status " + std::to_string(status)).c_str()) {}
+
+myhtmlpp::limit_exceeded::limit_exceeded(LIMIT limit)
+    : myhtml_error(limit_exceeded_status,
+                   ("parse limit exceeded: " + std::string(limit_name(limit)))
+                       .c_str()),
+      m_limit(limit) {}
+
+myhtmlpp::LIMIT myhtmlpp::limit_exceeded::limit() const { return m_limit; }
+
+myhtmlpp::cancelled_error::cancelled_error()
+    : myhtml_error(cancelled_status, "operation cancelled") {}
+
+myhtmlpp::serialization_error::serialization_error(mystatus_t status)
+    : myhtml_error(status, ("serialization failed with status " +
+                            std::to_string(status))
+                               .c_str()) {}
+
+myhtmlpp::selector_error::selector_error(mystatus_t status,
+                                         std::string_view selector)
+    : myhtml_error(status, ("invalid selector \"" + std::string(selector) +
+                            "\" (status " + std::to_string(status) + ")")
+                               .c_str()) {}
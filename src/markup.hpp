@@ -0,0 +1,63 @@
+#pragma once
+
+#include "myhtmlpp/constants.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace myhtmlpp {
+
+using AttributeList = std::vector<std::pair<std::string, std::string>>;
+
+// the prefix of an attribute key in the namespace `ns` as it is serialized,
+// e.g. "xlink:" for xlink:href. the xmlns attribute itself has none.
+inline std::string_view attribute_prefix(NAMESPACE ns, std::string_view key) {
+    switch (ns) {
+        case NAMESPACE::XML:
+            return "xml:";
+        case NAMESPACE::XMLNS:
+            return key != "xmlns" ? "xmlns:" : "";
+        case NAMESPACE::XLINK:
+            return "xlink:";
+        default:
+            return "";
+    }
+}
+
+// appends `value` escaped for a double-quoted attribute value.
+inline void append_attribute_value(std::string& out, std::string_view value) {
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '&') {
+            out.append("&amp;");
+        } else if (value[i] == '"') {
+            out.append("&quot;");
+        } else if (value[i] == '\xC2' && i + 1 < value.size() &&
+                   value[i + 1] == '\xA0') {
+            out.append("&nbsp;");
+            ++i;
+        } else {
+            out.push_back(value[i]);
+        }
+    }
+}
+
+// appends a start tag with double-quoted attribute values.
+inline void append_start_tag(std::string& out, std::string_view name,
+                             const AttributeList& attributes,
+                             bool self_closing) {
+    out.append("<");
+    out.append(name);
+    for (const auto& [key, value] : attributes) {
+        out.append(" ");
+        out.append(key);
+        out.append("=\"");
+        append_attribute_value(out, value);
+        out.append("\"");
+    }
+    out.append(self_closing ? "/>" : ">");
+}
+
+}  // namespace myhtmlpp
@@ -2,18 +2,134 @@
 
 #include "myhtmlpp/attribute.hpp"
 #include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/tag_names.hpp"
+#include "tree_info.hpp"
 #include "utils.hpp"
 
-#include <cstring>
-#include <mycore/myosi.h>
-#include <mycore/mystring.h>
-#include <myhtml/serialization.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <myhtml/tree.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+namespace {
+
+using myhtmlpp::SourceRange;
+using myhtmlpp::TAG;
+
+// the range of the token `node` was created from, std::nullopt for nodes
+// that were not created from a token.
+std::optional<SourceRange> token_range(myhtml_tree_node_t* node) {
+    myhtml_position_t position = myhtml_node_element_position(node);
+    if (position.length == 0) {
+        return std::nullopt;
+    }
+
+    return SourceRange{position.begin, position.begin + position.length};
+}
+
+// whether `node` is an element that can have an end tag.
+bool has_end_tag(myhtml_tree_node_t* node) {
+    switch (static_cast<TAG>(myhtml_node_tag_id(node))) {
+        case TAG::UNDEF_:
+        case TAG::TEXT_:
+        case TAG::COMMENT_:
+        case TAG::DOCTYPE_:
+            return false;
+        default:
+            return !myhtml_node_is_void_element(node);
+    }
+}
+
+// returns the offset after the end tag of `node` if `source` continues
+// with it at `offset`, `offset` otherwise.
+size_t skip_end_tag(std::string_view source, size_t offset,
+                    myhtml_tree_node_t* node) {
+    if (offset >= source.size() || source.substr(offset, 2) != "</") {
+        return offset;
+    }
+
+    size_t length = 0;
+    const char* raw_name = myhtml_tag_name_by_id(
+        myhtml_node_tree(node), myhtml_node_tag_id(node), &length);
+    if (raw_name == nullptr) {
+        return offset;
+    }
+
+    std::string_view name(raw_name, length);
+    std::string_view tag = source.substr(offset + 2, length);
+    auto lower = [](char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    };
+    if (tag.size() != name.size() ||
+        !std::equal(tag.begin(), tag.end(), name.begin(),
+                    [&](char a, char b) { return lower(a) == lower(b); })) {
+        return offset;
+    }
+
+    size_t after = offset + 2 + length;
+    if (after < source.size() &&
+        std::string_view(" \t\n\r\f/>").find(source[after]) ==
+            std::string_view::npos) {
+        return offset;
+    }
+
+    size_t close = source.find('>', after);
+
+    return close != std::string_view::npos ? close + 1 : offset;
+}
+
+// returns the nodes from the root of the tree that contains `node`
+// down to `node`.
+std::vector<myhtml_tree_node_t*> path_from_root(myhtml_tree_node_t* node) {
+    std::vector<myhtml_tree_node_t*> path;
+    for (; node != nullptr; node = myhtml_node_parent(node)) {
+        path.push_back(node);
+    }
+
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+// Node::document_position for nodes without an order index.
+myhtmlpp::DOCUMENT_POSITION position_by_walking(myhtml_tree_node_t* node,
+                                                myhtml_tree_node_t* other) {
+    using myhtmlpp::DOCUMENT_POSITION;
+
+    auto node_path = path_from_root(node);
+    auto other_path = path_from_root(other);
+    if (node_path.front() != other_path.front()) {
+        return DOCUMENT_POSITION::DISCONNECTED;
+    }
+
+    auto [node_it, other_it] = std::mismatch(
+        node_path.begin(), node_path.end(), other_path.begin(),
+        other_path.end());
+    if (node_it == node_path.end()) {
+        return DOCUMENT_POSITION::CONTAINED_BY;
+    }
+    if (other_it == other_path.end()) {
+        return DOCUMENT_POSITION::CONTAINS;
+    }
+
+    // *node_it and *other_it are different children of the same parent
+    for (auto* sibling = myhtml_node_next(*node_it); sibling != nullptr;
+         sibling = myhtml_node_next(sibling)) {
+        if (sibling == *other_it) {
+            return DOCUMENT_POSITION::FOLLOWING;
+        }
+    }
+
+    return DOCUMENT_POSITION::PRECEDING;
+}
+
+}  // namespace
+
 myhtmlpp::Node::Node(myhtml_tree_node_t* raw_node) : m_raw_node(raw_node) {}
 
 myhtmlpp::Node::Node(Node&& other) noexcept : m_raw_node(other.m_raw_node) {
@@ -37,54 +153,117 @@ bool myhtmlpp::Node::operator!=(const Node& other) const {
 }
 
 std::string myhtmlpp::Node::operator[](const std::string& key) const noexcept {
-    myhtml_tree_attr_t* attr =
-        myhtml_attribute_by_key(m_raw_node, key.c_str(), strlen(key.c_str()));
+    return std::string(value_view(key));
+}
 
-    return myhtml_attribute_value(attr, nullptr);
+std::string_view myhtmlpp::Node::value_view(std::string_view key) const {
+    return at_view(key).value_or(std::string_view());
 }
 
 bool myhtmlpp::Node::good() const { return m_raw_node != nullptr; }
 
 std::string myhtmlpp::Node::html() const {
-    mycore_string_raw_t str = {nullptr, 0, 0};
-    myhtml_serialization_node_buffer(m_raw_node, &str);
+    std::string res;
+    write_html([&res](std::string_view chunk) { res.append(chunk); });
 
-    std::string res = str.data != nullptr ? str.data : "";
+    return res;
+}
 
-    mycore_string_raw_destroy(&str, false);
+std::string myhtmlpp::Node::html_deep() const {
+    std::string res;
+    write_html_deep([&res](std::string_view chunk) { res.append(chunk); });
 
     return res;
 }
 
-std::string myhtmlpp::Node::html_deep() const {
-    mycore_string_raw_t str = {nullptr, 0, 0};
-    myhtml_serialization_tree_buffer(m_raw_node, &str);
+std::string myhtmlpp::Node::text() const { return std::string(text_view()); }
 
-    std::string res = str.data != nullptr ? str.data : "";
+std::optional<myhtmlpp::SourceRange> myhtmlpp::Node::source_range() const {
+    if (!good()) {
+        return std::nullopt;
+    }
+
+    myhtml_tree_t* tree = myhtml_node_tree(m_raw_node);
+    std::string_view source = source_of(tree);
+    if (m_raw_node == myhtml_tree_get_document(tree)) {
+        return !source.empty() ? std::make_optional(SourceRange{
+                                     0, source.size()})
+                               : std::nullopt;
+    }
 
-    mycore_string_raw_destroy(&str, false);
+    // implied elements start with their first descendant that has a
+    // token, which need not be a first child: the implied <head> of
+    // "<p>x</p>" is empty.
+    std::optional<SourceRange> first;
+    find_in_subtree(m_raw_node, [&](myhtml_tree_node_t* node) {
+        first = token_range(node);
+        return first.has_value();
+    });
+    if (!first) {
+        return std::nullopt;
+    }
 
-    return res;
+    // the end tags of the last descendants follow each other, so the end
+    // is found by going down the last children and back up again.
+    std::vector<myhtml_tree_node_t*> last;
+    for (myhtml_tree_node_t* node = m_raw_node; node != nullptr;
+         node = myhtml_node_last_child(node)) {
+        last.push_back(node);
+    }
+
+    size_t end = first->end;
+    for (auto it = last.rbegin(); it != last.rend(); ++it) {
+        if (auto range = token_range(*it)) {
+            end = std::max(end, range->end);
+        }
+        if (has_end_tag(*it)) {
+            end = skip_end_tag(source, end, *it);
+        }
+    }
+
+    return SourceRange{first->begin, end};
+}
+
+std::string_view myhtmlpp::Node::raw_html() const {
+    auto range = source_range();
+    if (!range) {
+        return std::string_view();
+    }
+
+    std::string_view source = source_of(myhtml_node_tree(m_raw_node));
+    if (range->end > source.size()) {
+        return std::string_view();
+    }
+
+    return source.substr(range->begin, range->size());
 }
 
-std::string myhtmlpp::Node::text() const {
-    const char* raw_text = myhtml_node_text(m_raw_node, nullptr);
+std::string_view myhtmlpp::Node::text_view() const {
+    size_t length = 0;
+    const char* raw_text = myhtml_node_text(m_raw_node, &length);
 
-    return raw_text != nullptr ? raw_text : "";
+    return raw_text != nullptr ? std::string_view(raw_text, length)
+                               : std::string_view();
 }
 
 std::string myhtmlpp::Node::inner_text() const {
     std::string res;
+    inner_text_into(res);
 
-    if (tag_id() == TAG::TEXT_) {
-        res += text();
-    }
+    return res;
+}
 
-    for (const auto& ch : children()) {
-        res += ch.inner_text();
-    }
+void myhtmlpp::Node::inner_text_into(std::string& out) const {
+    out.reserve(out.size() + inner_text_length());
 
-    return res;
+    for_each_text([&](std::string_view text) { out.append(text); });
+}
+
+size_t myhtmlpp::Node::inner_text_length() const {
+    size_t length = 0;
+    for_each_text([&](std::string_view text) { length += text.size(); });
+
+    return length;
 }
 
 myhtmlpp::TAG myhtmlpp::Node::tag_id() const {
@@ -92,10 +271,22 @@ myhtmlpp::TAG myhtmlpp::Node::tag_id() const {
 }
 
 std::string myhtmlpp::Node::tag_name() const {
+    return std::string(tag_name_view());
+}
+
+std::string_view myhtmlpp::Node::tag_name_view() const {
+    auto tag_id = static_cast<TAG>(myhtml_node_tag_id(m_raw_node));
+    if (tag_id < TAG::LAST_ENTRY) {
+        return myhtmlpp::tag_name(tag_id);
+    }
+
+    // custom tags are registered in the tree
+    size_t length = 0;
     const char* tag_name = myhtml_tag_name_by_id(
-        m_raw_node->tree, myhtml_node_tag_id(m_raw_node), nullptr);
+        m_raw_node->tree, myhtml_node_tag_id(m_raw_node), &length);
 
-    return tag_name != nullptr ? tag_name : "";
+    return tag_name != nullptr ? std::string_view(tag_name, length)
+                               : std::string_view();
 }
 
 myhtmlpp::NAMESPACE myhtmlpp::Node::get_namespace() const {
@@ -165,21 +356,111 @@ std::vector<myhtmlpp::Node> myhtmlpp::Node::siblings() const {
     return res;
 }
 
+bool myhtmlpp::Node::is_ancestor_of(const Node& other) const {
+    if (!good() || !other.good() || m_raw_node == other.m_raw_node) {
+        return false;
+    }
+
+    const NodeInfo* info = TreeInfo::lookup(m_raw_node);
+    const NodeInfo* other_info = TreeInfo::lookup(other.m_raw_node);
+    if (info != nullptr && other_info != nullptr) {
+        return m_raw_node->tree == other.m_raw_node->tree &&
+               info->pre < other_info->pre &&
+               other_info->pre < info->subtree_end;
+    }
+
+    for (auto* parent = myhtml_node_parent(other.m_raw_node);
+         parent != nullptr; parent = myhtml_node_parent(parent)) {
+        if (parent == m_raw_node) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+myhtmlpp::DOCUMENT_POSITION
+myhtmlpp::Node::document_position(const Node& other) const {
+    if (!good() || !other.good() ||
+        m_raw_node->tree != other.m_raw_node->tree) {
+        return DOCUMENT_POSITION::DISCONNECTED;
+    }
+
+    if (m_raw_node == other.m_raw_node) {
+        return DOCUMENT_POSITION::EQUAL;
+    }
+
+    const NodeInfo* info = TreeInfo::lookup(m_raw_node);
+    const NodeInfo* other_info = TreeInfo::lookup(other.m_raw_node);
+    if (info == nullptr || other_info == nullptr) {
+        return position_by_walking(m_raw_node, other.m_raw_node);
+    }
+
+    if (info->pre < other_info->pre && other_info->pre < info->subtree_end) {
+        return DOCUMENT_POSITION::CONTAINED_BY;
+    }
+
+    if (other_info->pre < info->pre && info->pre < other_info->subtree_end) {
+        return DOCUMENT_POSITION::CONTAINS;
+    }
+
+    return other_info->pre < info->pre ? DOCUMENT_POSITION::PRECEDING
+                                       : DOCUMENT_POSITION::FOLLOWING;
+}
+
+size_t myhtmlpp::Node::subtree_size() const {
+    if (const NodeInfo* info = TreeInfo::lookup(m_raw_node)) {
+        return info->subtree_end - info->pre;
+    }
+
+    size_t size = 0;
+    walk_subtree(m_raw_node, [&](myhtml_tree_node_t* /*unused*/) { ++size; });
+
+    return size;
+}
+
+std::optional<size_t> myhtmlpp::Node::pre_order_index() const {
+    if (const NodeInfo* info = TreeInfo::lookup(m_raw_node)) {
+        return info->pre;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<size_t> myhtmlpp::Node::post_order_index() const {
+    if (const NodeInfo* info = TreeInfo::lookup(m_raw_node)) {
+        return info->post;
+    }
+
+    return std::nullopt;
+}
+
 std::optional<std::string> myhtmlpp::Node::at(const std::string& key) const {
+    if (auto val = at_view(key)) {
+        return std::string(val.value());
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::string_view>
+myhtmlpp::Node::at_view(std::string_view key) const {
     if (!good()) {
         return std::nullopt;
     }
 
     myhtml_tree_attr_t* attr =
-        myhtml_attribute_by_key(m_raw_node, key.c_str(), strlen(key.c_str()));
+        myhtml_attribute_by_key(m_raw_node, key.data(), key.size());
 
     if (attr == nullptr) {
         return std::nullopt;
     }
 
-    const char* val = myhtml_attribute_value(attr, nullptr);
+    size_t length = 0;
+    const char* val = myhtml_attribute_value(attr, &length);
 
-    return val != nullptr ? std::make_optional(val) : std::nullopt;
+    return val != nullptr ? std::make_optional(std::string_view(val, length))
+                          : std::nullopt;
 }
 
 bool myhtmlpp::Node::has_attributes() const {
@@ -188,7 +469,7 @@ bool myhtmlpp::Node::has_attributes() const {
 
 bool myhtmlpp::Node::has_attribute(const std::string& key) const {
     myhtml_tree_attr_t* attr =
-        myhtml_attribute_by_key(m_raw_node, key.c_str(), strlen(key.c_str()));
+        myhtml_attribute_by_key(m_raw_node, key.c_str(), key.size());
 
     return attr != nullptr;
 }
@@ -286,7 +567,32 @@ myhtmlpp::Node::ConstIterator myhtmlpp::Node::cend() const noexcept {
 }
 
 std::ostream& myhtmlpp::operator<<(std::ostream& os, const myhtmlpp::Node& n) {
-    os << n.html();
+    n.write_html(ostream_sink(os));
 
     return os;
 }
+
+bool myhtmlpp::DocumentOrder::operator()(const Node& lhs,
+                                         const Node& rhs) const {
+    myhtml_tree_node_t* raw_lhs = RawAccess::node(lhs);
+    myhtml_tree_node_t* raw_rhs = RawAccess::node(rhs);
+
+    const NodeInfo* lhs_info = TreeInfo::lookup(raw_lhs);
+    const NodeInfo* rhs_info = TreeInfo::lookup(raw_rhs);
+    if (lhs_info != nullptr && rhs_info != nullptr &&
+        raw_lhs->tree == raw_rhs->tree) {
+        return lhs_info->pre < rhs_info->pre;
+    }
+
+    switch (lhs.document_position(rhs)) {
+    case DOCUMENT_POSITION::FOLLOWING:
+    case DOCUMENT_POSITION::CONTAINED_BY:
+        return true;
+    case DOCUMENT_POSITION::DISCONNECTED:
+        // nodes of different trees are ordered by the address of their
+        // node, which is at least consistent.
+        return std::less<myhtml_tree_node_t*>()(raw_lhs, raw_rhs);
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,271 @@
+#include "myhtmlpp/node_set.hpp"
+
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "tree_info.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <myhtml/tree.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr size_t bits_per_word = 64;
+
+constexpr size_t no_position = static_cast<size_t>(-1);
+
+}  // namespace
+
+myhtmlpp::NodeSet::NodeSet(const Tree& tree) : m_info(RawAccess::info(tree)) {
+    if (m_info == nullptr || !m_info->has_order_index()) {
+        throw std::logic_error("NodeSet requires a tree with an order index");
+    }
+
+    m_generation = m_info->generation();
+    m_bits.resize((m_info->order().size() + bits_per_word - 1) /
+                  bits_per_word);
+}
+
+myhtmlpp::NodeSet::NodeSet(const Tree& tree, const std::vector<Node>& nodes)
+    : NodeSet(tree) {
+    for (const auto& node : nodes) {
+        insert(node);
+    }
+}
+
+bool myhtmlpp::NodeSet::insert(const Node& node) {
+    size_t pos = position(node);
+    if (pos == no_position) {
+        throw std::invalid_argument(
+            "node is not numbered by the order index of the tree");
+    }
+
+    uint64_t& word = m_bits[pos / bits_per_word];
+    uint64_t mask = uint64_t{1} << (pos % bits_per_word);
+    bool inserted = (word & mask) == 0;
+    word |= mask;
+
+    return inserted;
+}
+
+bool myhtmlpp::NodeSet::erase(const Node& node) {
+    size_t pos = position(node);
+    if (pos == no_position) {
+        return false;
+    }
+
+    uint64_t& word = m_bits[pos / bits_per_word];
+    uint64_t mask = uint64_t{1} << (pos % bits_per_word);
+    bool erased = (word & mask) != 0;
+    word &= ~mask;
+
+    return erased;
+}
+
+bool myhtmlpp::NodeSet::contains(const Node& node) const {
+    size_t pos = position(node);
+    if (pos == no_position) {
+        return false;
+    }
+
+    return (m_bits[pos / bits_per_word] >> (pos % bits_per_word) & 1U) != 0;
+}
+
+size_t myhtmlpp::NodeSet::size() const {
+    size_t count = 0;
+    for (uint64_t word : m_bits) {
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+
+    return count;
+}
+
+bool myhtmlpp::NodeSet::empty() const {
+    for (uint64_t word : m_bits) {
+        if (word != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void myhtmlpp::NodeSet::clear() {
+    std::fill(m_bits.begin(), m_bits.end(), 0);
+}
+
+std::vector<myhtmlpp::Node> myhtmlpp::NodeSet::to_vector() const {
+    std::vector<Node> res;
+    res.reserve(size());
+
+    const auto& order = m_info->order();
+    for (size_t pos = next_position(0); pos < order.size();
+         pos = next_position(pos + 1)) {
+        res.emplace_back(order[pos]);
+    }
+
+    return res;
+}
+
+myhtmlpp::NodeSet& myhtmlpp::NodeSet::operator|=(const NodeSet& other) {
+    check_same_tree(other);
+
+    for (size_t i = 0; i < m_bits.size(); ++i) {
+        m_bits[i] |= other.m_bits[i];
+    }
+
+    return *this;
+}
+
+myhtmlpp::NodeSet& myhtmlpp::NodeSet::operator&=(const NodeSet& other) {
+    check_same_tree(other);
+
+    for (size_t i = 0; i < m_bits.size(); ++i) {
+        m_bits[i] &= other.m_bits[i];
+    }
+
+    return *this;
+}
+
+myhtmlpp::NodeSet& myhtmlpp::NodeSet::operator-=(const NodeSet& other) {
+    check_same_tree(other);
+
+    for (size_t i = 0; i < m_bits.size(); ++i) {
+        m_bits[i] &= ~other.m_bits[i];
+    }
+
+    return *this;
+}
+
+bool myhtmlpp::NodeSet::operator==(const NodeSet& other) const {
+    return m_info == other.m_info && m_bits == other.m_bits;
+}
+
+bool myhtmlpp::NodeSet::operator!=(const NodeSet& other) const {
+    return !operator==(other);
+}
+
+size_t myhtmlpp::NodeSet::position(const Node& node) const {
+    check_generation();
+
+    myhtml_tree_node_t* raw_node = RawAccess::node(node);
+
+    const NodeInfo* info = TreeInfo::lookup(raw_node);
+    if (info == nullptr || info->pre >= m_info->order().size() ||
+        m_info->order()[info->pre] != raw_node) {
+        return no_position;
+    }
+
+    return info->pre;
+}
+
+size_t myhtmlpp::NodeSet::next_position(size_t position) const {
+    check_generation();
+
+    size_t count = m_info->order().size();
+    if (position >= count) {
+        return count;
+    }
+
+    size_t index = position / bits_per_word;
+    uint64_t word =
+        m_bits[index] & (~uint64_t{0} << (position % bits_per_word));
+
+    while (word == 0) {
+        if (++index == m_bits.size()) {
+            return count;
+        }
+
+        word = m_bits[index];
+    }
+
+    return index * bits_per_word +
+           static_cast<size_t>(__builtin_ctzll(word));
+}
+
+void myhtmlpp::NodeSet::check_generation() const {
+    // the bits are sized for the index the set was created with, a rebuilt
+    // index may number more nodes or number them differently.
+    if (m_info->generation() != m_generation) {
+        throw std::logic_error(
+            "the order index of the tree was cleared or rebuilt");
+    }
+}
+
+void myhtmlpp::NodeSet::check_same_tree(const NodeSet& other) const {
+    check_generation();
+    other.check_generation();
+
+    if (m_info != other.m_info || m_bits.size() != other.m_bits.size()) {
+        throw std::invalid_argument("NodeSets belong to different trees");
+    }
+}
+
+// ConstIterator
+myhtmlpp::NodeSet::ConstIterator::ConstIterator(const NodeSet* set,
+                                                size_t position)
+    : m_set(set), m_position(set->next_position(position)), m_node(nullptr) {
+    if (m_position < m_set->m_info->order().size()) {
+        m_node = Node(m_set->m_info->order()[m_position]);
+    }
+}
+
+myhtmlpp::NodeSet::ConstIterator::reference
+    myhtmlpp::NodeSet::ConstIterator::operator*() const {
+    return m_node;
+}
+
+myhtmlpp::NodeSet::ConstIterator& myhtmlpp::NodeSet::ConstIterator::
+operator++() {
+    *this = ConstIterator(m_set, m_position + 1);
+
+    return *this;
+}
+
+bool myhtmlpp::NodeSet::ConstIterator::operator==(
+    const ConstIterator& other) const {
+    return m_set == other.m_set && m_position == other.m_position;
+}
+
+bool myhtmlpp::NodeSet::ConstIterator::operator!=(
+    const ConstIterator& other) const {
+    return !operator==(other);
+}
+
+myhtmlpp::NodeSet::ConstIterator myhtmlpp::NodeSet::begin() const {
+    return ConstIterator(this, 0);
+}
+
+myhtmlpp::NodeSet::ConstIterator myhtmlpp::NodeSet::end() const {
+    return ConstIterator(this, m_info->order().size());
+}
+
+myhtmlpp::NodeSet::ConstIterator myhtmlpp::NodeSet::cbegin() const {
+    return begin();
+}
+
+myhtmlpp::NodeSet::ConstIterator myhtmlpp::NodeSet::cend() const {
+    return end();
+}
+
+myhtmlpp::NodeSet myhtmlpp::operator|(NodeSet lhs, const NodeSet& rhs) {
+    lhs |= rhs;
+
+    return lhs;
+}
+
+myhtmlpp::NodeSet myhtmlpp::operator&(NodeSet lhs, const NodeSet& rhs) {
+    lhs &= rhs;
+
+    return lhs;
+}
+
+myhtmlpp::NodeSet myhtmlpp::operator-(NodeSet lhs, const NodeSet& rhs) {
+    lhs -= rhs;
+
+    return lhs;
+}
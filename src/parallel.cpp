@@ -0,0 +1,263 @@
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/tag_names.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "thread_pool.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <myhtml/tree.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A unit of work: either a single node or a whole subtree.
+struct Task {
+    myhtml_tree_node_t* node;
+    bool subtree;
+};
+
+// number of tasks created per thread, more tasks balance uneven subtrees.
+constexpr size_t tasks_per_thread = 4;
+
+// limits how deep the tree is split; below that the subtrees are searched
+// as a whole.
+constexpr size_t max_split_depth = 8;
+
+// Splits the subtree of `scope` into tasks in document order.
+// Expanding a subtree task replaces it with a single node task for its
+// root followed by one subtree task per child, which keeps the order of the
+// tasks equal to the document order of the nodes they cover.
+std::vector<Task> partition(myhtml_tree_node_t* scope, size_t target) {
+    std::vector<Task> tasks{{scope, true}};
+
+    for (size_t depth = 0; depth < max_split_depth; ++depth) {
+        auto subtrees = static_cast<size_t>(
+            std::count_if(tasks.begin(), tasks.end(),
+                          [](const Task& t) { return t.subtree; }));
+        if (subtrees >= target) {
+            break;
+        }
+
+        std::vector<Task> expanded;
+        expanded.reserve(tasks.size() * 2);
+
+        bool changed = false;
+        for (const auto& task : tasks) {
+            myhtml_tree_node_t* child = myhtml_node_child(task.node);
+            if (!task.subtree || child == nullptr) {
+                expanded.push_back(task);
+                continue;
+            }
+
+            expanded.push_back({task.node, false});
+            for (; child != nullptr; child = myhtml_node_next(child)) {
+                expanded.push_back({child, true});
+            }
+
+            changed = true;
+        }
+
+        tasks.swap(expanded);
+
+        if (!changed) {
+            break;
+        }
+    }
+
+    return tasks;
+}
+
+void run_task(const Task& task,
+              const std::function<bool(const myhtmlpp::Node&)>& f,
+              std::vector<myhtmlpp::Node>& out) {
+    auto visit = [&](myhtml_tree_node_t* raw_node) {
+        myhtmlpp::Node node(raw_node);
+        if (f(node)) {
+            out.push_back(std::move(node));
+        }
+    };
+
+    if (task.subtree) {
+        walk_subtree(task.node, visit);
+    } else {
+        visit(task.node);
+    }
+}
+
+// State shared between the calling thread and the pool workers.
+// Tasks are claimed through `next`, so the calling thread can work on the
+// tasks itself and never waits for a job that has not been started; this
+// keeps nested parallel queries from dead locking the pool.
+// An exception thrown by `f` is stored and the remaining tasks are skipped,
+// but every task is still counted as done: the caller always waits for all
+// of them before rethrowing, so no worker can outlive the frames `f`
+// refers to.
+struct SharedState {
+    std::vector<Task> tasks;
+    std::vector<std::vector<myhtmlpp::Node>> results;
+    std::function<bool(const myhtmlpp::Node&)> f;
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    size_t done = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    void work() {
+        size_t finished = 0;
+        for (size_t i = next++; i < tasks.size(); i = next++) {
+            if (!failed) {
+                try {
+                    run_task(tasks[i], f, results[i]);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+            ++finished;
+        }
+
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done += finished;
+            if (done == tasks.size()) {
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+}  // namespace
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_collect(const Node& scope_node,
+                                 const std::function<bool(const Node&)>& f,
+                                 size_t thread_count) const {
+    myhtml_tree_node_t* scope = RawAccess::node(scope_node);
+    if (scope == nullptr) {
+        return {};
+    }
+
+    ThreadPool& pool = ThreadPool::shared();
+    if (thread_count == 0 || thread_count > pool.size()) {
+        thread_count = pool.size();
+    }
+
+    if (thread_count <= 1) {
+        std::vector<Node> res;
+        run_task({scope, true}, f, res);
+
+        return res;
+    }
+
+    auto state = std::make_shared<SharedState>();
+    state->tasks = partition(scope, thread_count * tasks_per_thread);
+    state->results.resize(state->tasks.size());
+    state->f = f;
+
+    size_t helpers = std::min(thread_count, state->tasks.size()) - 1;
+    for (size_t i = 0; i < helpers; ++i) {
+        pool.post([state] { state->work(); });
+    }
+
+    state->work();
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock,
+                       [&] { return state->done == state->tasks.size(); });
+    }
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+
+    size_t total = 0;
+    for (const auto& part : state->results) {
+        total += part.size();
+    }
+
+    std::vector<Node> res;
+    res.reserve(total);
+    for (auto& part : state->results) {
+        res.insert(res.end(), part.begin(), part.end());
+    }
+
+    return res;
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_find_by_tag(const std::string& tag,
+                                     size_t thread_count) const {
+    TAG tag_id = tag_from_name(tag);
+    if (tag_id != TAG::UNDEF_) {
+        return parallel_find_by_tag(tag_id, thread_count);
+    }
+
+    return parallel_filter(
+        [&](const Node& node) { return node.tag_name_view() == tag; },
+        thread_count);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_find_by_tag(myhtmlpp::TAG tag,
+                                     size_t thread_count) const {
+    return parallel_filter(
+        [&](const Node& node) { return node.tag_id() == tag; }, thread_count);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_find_by_class(const std::string& cl,
+                                       size_t thread_count) const {
+    return parallel_filter(
+        [&](const Node& node) {
+            if (auto cl_value = node.at("class")) {
+                return cl_value.value() == cl;
+            }
+
+            return false;
+        },
+        thread_count);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_find_by_id(const std::string& id,
+                                    size_t thread_count) const {
+    return parallel_filter(
+        [&](const Node& node) {
+            if (auto id_value = node.at("id")) {
+                return id_value.value() == id;
+            }
+
+            return false;
+        },
+        thread_count);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::parallel_find_by_attr(const std::string& key,
+                                      const std::string& val,
+                                      size_t thread_count) const {
+    return parallel_filter(
+        [&](const Node& node) {
+            if (auto attr = node.at(key)) {
+                return attr.value() == val;
+            }
+
+            return false;
+        },
+        thread_count);
+}
@@ -1,53 +1,530 @@
 #include "myhtmlpp/parser.hpp"
 
+#include "elements.hpp"
+#include "engine_pool.hpp"
 #include "myhtmlpp/constants.hpp"
 #include "myhtmlpp/error.hpp"
+#include "myhtmlpp/result.hpp"
 #include "myhtmlpp/tree.hpp"
+#include "thread_pool.hpp"
+#include "tree_info.hpp"
+#include "utils.hpp"
 
+#include <algorithm>
 #include <cstddef>
-#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mycore/myosi.h>
+#include <myencoding/encoding.h>
 #include <myencoding/myosi.h>
+#include <myhtml/myhtml.h>
 #include <myhtml/myosi.h>
+#include <myhtml/token.h>
 #include <myhtml/tree.h>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 
-template <typename ParseFunc, typename... ParseArgs>
-myhtmlpp::Tree parse_helper(ParseFunc f, const std::string& html,
-                            myhtmlpp::OPTION opt, size_t thread_count,
-                            size_t queue_size, ParseArgs... args) {
-    myhtml_t* raw_myhtml = myhtml_create();
-    mystatus_t init_st = myhtml_init(
-        raw_myhtml, static_cast<myhtml_options>(opt), thread_count, queue_size);
+namespace {
+
+using myhtmlpp::ENCODING;
+using myhtmlpp::TAG;
+
+static_assert(static_cast<myencoding_t>(ENCODING::UTF_8) == MyENCODING_UTF_8);
+static_assert(static_cast<myencoding_t>(ENCODING::ISO_8859_8_I) ==
+              MyENCODING_ISO_8859_8_I);
+static_assert(static_cast<myencoding_t>(ENCODING::WINDOWS_1252) ==
+              MyENCODING_WINDOWS_1252);
+static_assert(static_cast<myencoding_t>(ENCODING::LAST_ENTRY) ==
+              MyENCODING_LAST_ENTRY);
+
+// the encoding `input` is decoded from. A byte order mark overrides the
+// options and is cut off `input`.
+myencoding_t input_encoding(std::string_view& input,
+                            const myhtmlpp::ParseOptions& options) {
+    myencoding_t bom_encoding = MyENCODING_DEFAULT;
+    const char* text = nullptr;
+    size_t size = 0;
+    if (myencoding_detect_and_cut_bom(input.data(), input.size(),
+                                      &bom_encoding, &text, &size)) {
+        input = std::string_view(text, size);
+        return bom_encoding;
+    }
+
+    ENCODING encoding = options.encoding;
+    if (encoding == ENCODING::AUTO) {
+        encoding = myhtmlpp::detect_encoding(input).value_or(
+            options.fallback_encoding);
+    }
+    if (encoding == ENCODING::AUTO) {
+        encoding = ENCODING::UTF_8;
+    }
+
+    return static_cast<myencoding_t>(encoding);
+}
+
+bool is_whitespace(myhtml_tree_t* tree, myhtml_tree_node_t* node) {
+    // the text of a token may still be processed by another myhtml thread
+    myhtml_token_node_wait_for_done(tree->token, node->token);
+
+    size_t length = 0;
+    const char* text = myhtml_node_text(node, &length);
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];  // NOLINT
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\f') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool drop_text(myhtml_tree_t* tree, myhtml_tree_node_t* node,
+               const myhtmlpp::ParseOptions& options) {
+    myhtml_tree_node_t* parent = myhtml_node_parent(node);
+    if (parent == nullptr) {
+        return false;
+    }
+
+    auto parent_tag = static_cast<TAG>(myhtml_node_tag_id(parent));
+    if ((parent_tag == TAG::SCRIPT && options.drop_script_text) ||
+        (parent_tag == TAG::STYLE && options.drop_style_text)) {
+        return true;
+    }
+
+    if (!options.drop_whitespace_text || !is_whitespace(tree, node)) {
+        return false;
+    }
+
+    for (; parent != nullptr; parent = myhtml_node_parent(parent)) {
+        if (myhtmlpp::is_preformatted(
+                static_cast<TAG>(myhtml_node_tag_id(parent)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// state of a parse shared with the myhtml node insert callback.
+struct ParseContext {
+    const myhtmlpp::ParseOptions& options;
+
+    /// Set by the callback when a stop condition is reached or a limit is
+    /// exceeded.
+    bool stop = false;
+
+    /// The first limit that was exceeded.
+    std::optional<myhtmlpp::LIMIT> exceeded = std::nullopt;
+
+    /// An exception thrown by ParseOptions::stop_when, it must not unwind
+    /// through myhtml and is rethrown once myhtml returned.
+    std::exception_ptr error = nullptr;
+
+    /// The nodes inserted so far and their estimated memory.
+    size_t nodes = 0;
+    size_t memory = 0;
+};
+
+bool checks_limits(const myhtmlpp::ParseLimits& limits) {
+    return limits.depth != 0 || limits.nodes != 0 || limits.attributes != 0 ||
+           limits.tree_memory != 0;
+}
+
+// counts `node` and returns the first limit it exceeds.
+std::optional<myhtmlpp::LIMIT> exceeded_limit(myhtml_tree_t* tree,
+                                              myhtml_tree_node_t* node,
+                                              ParseContext& context) {
+    const myhtmlpp::ParseLimits& limits = context.options.limits;
+    auto tag = static_cast<TAG>(myhtml_node_tag_id(node));
+
+    ++context.nodes;
+    context.memory += sizeof(myhtml_tree_node_t) + sizeof(myhtml_token_node_t);
+
+    if (tag == TAG::TEXT_ || tag == TAG::COMMENT_) {
+        size_t length = 0;
+        myhtml_node_text(node, &length);
+        context.memory += length;
+    } else {
+        // the element is pushed onto the open elements after it is inserted
+        if (limits.depth != 0 && tree->open_elements->length >= limits.depth) {
+            return myhtmlpp::LIMIT::DEPTH;
+        }
+
+        size_t attributes = 0;
+        for (myhtml_tree_attr_t* attr = myhtml_node_attribute_first(node);
+             attr != nullptr; attr = myhtml_attribute_next(attr)) {
+            size_t key_length = 0;
+            size_t value_length = 0;
+            myhtml_attribute_key(attr, &key_length);
+            myhtml_attribute_value(attr, &value_length);
+
+            ++attributes;
+            context.memory +=
+                sizeof(myhtml_tree_attr_t) + key_length + value_length;
+        }
+        if (limits.attributes != 0 && attributes > limits.attributes) {
+            return myhtmlpp::LIMIT::ATTRIBUTES;
+        }
+    }
+
+    if (limits.nodes != 0 && context.nodes > limits.nodes) {
+        return myhtmlpp::LIMIT::NODES;
+    }
+    if (limits.tree_memory != 0 && context.memory > limits.tree_memory) {
+        return myhtmlpp::LIMIT::TREE_MEMORY;
+    }
+
+    return std::nullopt;
+}
+
+bool reached_stop(myhtml_tree_t* tree, myhtml_tree_node_t* node,
+                  const myhtmlpp::ParseOptions& options) {
+    auto tag = static_cast<TAG>(myhtml_node_tag_id(node));
+    switch (options.stop) {
+        case myhtmlpp::STOP::AFTER_HEAD: {
+            // after the head, nodes go into the body or next to the head
+            myhtml_tree_node_t* head = myhtml_tree_get_node_head(tree);
+            if (tag == TAG::BODY ||
+                (head != nullptr && node != head &&
+                 myhtml_node_parent(node) == myhtml_tree_get_node_html(tree))) {
+                return true;
+            }
+            break;
+        }
+        case myhtmlpp::STOP::AFTER_BODY_START:
+            if (tag == TAG::BODY) {
+                return true;
+            }
+            break;
+        case myhtmlpp::STOP::NEVER:
+            break;
+    }
+
+    return options.stop_when && options.stop_when(myhtmlpp::Node(node));
+}
+
+// myhtml node insert callback deleting the nodes the parse options drop,
+// so their memory is reused for the following nodes, and checking the
+// limits and stop conditions.
+void on_node_inserted(myhtml_tree_t* tree, myhtml_tree_node_t* node,
+                      void* ctx) {
+    auto& context = *static_cast<ParseContext*>(ctx);
+    const myhtmlpp::ParseOptions& options = context.options;
+
+    bool drop = false;
+    switch (static_cast<TAG>(myhtml_node_tag_id(node))) {
+        case TAG::COMMENT_:
+            drop = options.drop_comments;
+            break;
+        case TAG::TEXT_:
+            drop = drop_text(tree, node, options);
+            break;
+        default:
+            break;
+    }
+
+    if (drop) {
+        myhtml_node_delete(node);
+        return;
+    }
+    if (context.stop) {
+        return;
+    }
+
+    if (checks_limits(options.limits)) {
+        context.exceeded = exceeded_limit(tree, node, context);
+    }
+    try {
+        context.stop = context.exceeded || reached_stop(tree, node, options);
+    } catch (...) {
+        context.error = std::current_exception();
+        context.stop = true;
+    }
+}
+
+// why a parse failed: parse throws the matching exception, try_parse
+// returns the status.
+enum class FAILURE : unsigned int {
+    INIT = 0x00,
+    TREE_INIT = 0x01,
+    PARSE = 0x02,
+    LIMIT = 0x03,
+    CANCELLED = 0x04
+};
+
+struct ParseFailure {
+    FAILURE failure;
+    mystatus_t status;
+    myhtmlpp::LIMIT limit = myhtmlpp::LIMIT::INPUT_SIZE;
+};
+
+using ParseResult = myhtmlpp::Result<myhtmlpp::Tree, ParseFailure>;
+
+myhtmlpp::Failure<ParseFailure> limit_failure(myhtmlpp::LIMIT limit) {
+    return {{FAILURE::LIMIT, myhtmlpp::limit_exceeded_status, limit}};
+}
+
+myhtmlpp::Tree value_or_throw(ParseResult result) {
+    if (result) {
+        return std::move(result).value();
+    }
+
+    const ParseFailure& failure = result.error();
+    switch (failure.failure) {
+        case FAILURE::INIT:
+            throw myhtmlpp::init_error(failure.status);
+        case FAILURE::TREE_INIT:
+            throw myhtmlpp::tree_init_error(failure.status);
+        case FAILURE::LIMIT:
+            throw myhtmlpp::limit_exceeded(failure.limit);
+        case FAILURE::CANCELLED:
+            throw myhtmlpp::cancelled_error();
+        case FAILURE::PARSE:
+            break;
+    }
+
+    throw myhtmlpp::parse_error(failure.status);
+}
+
+myhtmlpp::Result<myhtmlpp::Tree, mystatus_t> to_status(ParseResult result) {
+    if (result) {
+        return std::move(result).value();
+    }
+
+    return myhtmlpp::Failure{result.error().status};
+}
+
+}  // namespace
+
+// parses `html` without throwing the exceptions of the library.
+template <typename ParseFunc, typename ChunkFunc, typename... ParseArgs>
+ParseResult parse_helper(ParseFunc f, ChunkFunc first_chunk,
+                         const std::string& html,
+                         const myhtmlpp::ParseOptions& options,
+                         ParseArgs... args) {
+    std::string_view input(html);
+    myencoding_t encoding = input_encoding(input, options);
+
+    size_t length = input.size();
+    size_t limit = options.stop_after_bytes != 0
+                       ? std::min(length, options.stop_after_bytes)
+                       : length;
+
+    const myhtmlpp::ParseLimits& limits = options.limits;
+    if (limits.input_size != 0 && length > limits.input_size) {
+        if (!limits.truncate) {
+            return limit_failure(myhtmlpp::LIMIT::INPUT_SIZE);
+        }
+        limit = std::min(limit, limits.input_size);
+    }
+
+    bool can_stop = options.stop != myhtmlpp::STOP::NEVER ||
+                    static_cast<bool>(options.stop_when) || limit < length ||
+                    checks_limits(limits) || options.cancellation.has_value();
+
+    // the tree is built in this thread to check the stop conditions as the
+    // chunks are parsed
+    myhtmlpp::OPTION opt =
+        can_stop ? myhtmlpp::OPTION::PARSE_MODE_SINGLE : options.opt;
+
+    myhtml_t* raw_myhtml = nullptr;
+    mystatus_t init_st = MyHTML_STATUS_OK;
+    if (options.reuse_engine) {
+        raw_myhtml = myhtmlpp::EnginePool::shared().acquire(init_st);
+    } else {
+        raw_myhtml = myhtml_create();
+        init_st = myhtml_init(raw_myhtml, static_cast<myhtml_options>(opt),
+                              options.thread_count, options.queue_size);
+        if (init_st != MyHTML_STATUS_OK) {
+            myhtml_destroy(raw_myhtml);
+        }
+    }
     if (init_st != MyHTML_STATUS_OK) {
-        throw myhtmlpp::init_error(init_st);
+        return myhtmlpp::Failure{ParseFailure{FAILURE::INIT, init_st}};
     }
 
     myhtml_tree_t* raw_tree = myhtml_tree_create();
     mystatus_t tree_st = myhtml_tree_init(raw_tree, raw_myhtml);
     if (tree_st != MyHTML_STATUS_OK) {
-        throw myhtmlpp::tree_init_error(tree_st);
+        myhtml_tree_destroy(raw_tree);
+        if (options.reuse_engine) {
+            myhtmlpp::EnginePool::shared().release(raw_myhtml);
+        } else {
+            myhtml_destroy(raw_myhtml);
+        }
+        return myhtmlpp::Failure{ParseFailure{FAILURE::TREE_INIT, tree_st}};
+    }
+
+    myhtmlpp::Tree tree(raw_myhtml, raw_tree);
+    myhtmlpp::RawAccess::info(tree)->set_pooled_engine(options.reuse_engine);
+
+    // myhtml keeps pointing into the parsed buffer for the source positions
+    const char* data = input.data();
+    if (options.keep_source) {
+        data = myhtmlpp::RawAccess::info(tree)->retain_source(input).data();
+    }
+
+    bool callback = can_stop || options.drop_comments ||
+                    options.drop_script_text || options.drop_style_text ||
+                    options.drop_whitespace_text;
+
+    ParseContext context{options};
+    if (callback) {
+        myhtml_callback_tree_node_insert_set(raw_tree, on_node_inserted,
+                                             &context);
+    }
+
+    mystatus_t parse_st = MyHTML_STATUS_OK;
+    bool cancelled = false;
+    if (!can_stop) {
+        parse_st = f(raw_tree, encoding, data, length, args...);
+    } else {
+        myhtml_encoding_set(raw_tree, encoding);
+
+        size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+        size_t offset = 0;
+        do {
+            if (options.cancellation && options.cancellation->cancelled()) {
+                cancelled = true;
+                break;
+            }
+
+            size_t size = std::min(chunk_size, limit - offset);
+            parse_st = offset == 0 ? first_chunk(raw_tree, data, size, args...)
+                                   : myhtml_parse_chunk(raw_tree,
+                                                        data + offset, size);
+            offset += size;
+        } while (parse_st == MyHTML_STATUS_OK && offset < limit &&
+                 !context.stop);
+
+        // closes the open elements as at the end of the input
+        if (parse_st == MyHTML_STATUS_OK && !cancelled) {
+            parse_st = myhtml_parse_chunk_end(raw_tree);
+        }
     }
 
-    mystatus_t parse_st = f(raw_tree, MyENCODING_UTF_8, html.c_str(),
-                            strlen(html.c_str()), args...);
+    if (callback) {
+        myhtml_callback_tree_node_insert_set(raw_tree, nullptr, nullptr);
+    }
+    // not a failure of the library, so try_parse rethrows it as well
+    if (context.error) {
+        std::rethrow_exception(context.error);
+    }
     if (parse_st != MyHTML_STATUS_OK) {
-        throw myhtmlpp::parse_error(parse_st);
+        return myhtmlpp::Failure{ParseFailure{FAILURE::PARSE, parse_st}};
+    }
+    if (cancelled) {
+        return myhtmlpp::Failure{
+            ParseFailure{FAILURE::CANCELLED, myhtmlpp::cancelled_status}};
+    }
+    if (context.exceeded && !limits.truncate) {
+        return limit_failure(*context.exceeded);
     }
 
-    return myhtmlpp::Tree(raw_myhtml, raw_tree);
+    return ParseResult(std::move(tree));
 }
 
 myhtmlpp::Tree myhtmlpp::parse(const std::string& html, myhtmlpp::OPTION opt,
                                size_t thread_count, size_t queue_size) {
-    return parse_helper(myhtml_parse, html, opt, thread_count, queue_size);
+    ParseOptions options;
+    options.opt = opt;
+    options.thread_count = thread_count;
+    options.queue_size = queue_size;
+
+    return parse(html, options);
+}
+
+myhtmlpp::Tree myhtmlpp::parse(const std::string& html,
+                               const ParseOptions& options) {
+    return value_or_throw(
+        parse_helper(myhtml_parse, myhtml_parse_chunk, html, options));
 }
 
 myhtmlpp::Tree
 myhtmlpp::parse_fragment(const std::string& html, myhtmlpp::TAG tag_id,
                          myhtmlpp::NAMESPACE ns, myhtmlpp::OPTION opt,
                          size_t thread_count, size_t queue_size) {
-    return parse_helper(myhtml_parse_fragment, html, opt, thread_count,
-                        queue_size, static_cast<myhtml_tag_id_t>(tag_id),
-                        static_cast<myhtml_namespace_t>(ns));
+    ParseOptions options;
+    options.opt = opt;
+    options.thread_count = thread_count;
+    options.queue_size = queue_size;
+
+    return parse_fragment(html, options, tag_id, ns);
+}
+
+myhtmlpp::Tree myhtmlpp::parse_fragment(const std::string& html,
+                                        const ParseOptions& options,
+                                        myhtmlpp::TAG tag_id,
+                                        myhtmlpp::NAMESPACE ns) {
+    return value_or_throw(parse_helper(
+        myhtml_parse_fragment, myhtml_parse_chunk_fragment, html, options,
+        static_cast<myhtml_tag_id_t>(tag_id),
+        static_cast<myhtml_namespace_t>(ns)));
+}
+
+myhtmlpp::Result<myhtmlpp::Tree, mystatus_t>
+myhtmlpp::try_parse(const std::string& html, const ParseOptions& options) {
+    return to_status(
+        parse_helper(myhtml_parse, myhtml_parse_chunk, html, options));
+}
+
+myhtmlpp::Result<myhtmlpp::Tree, mystatus_t>
+myhtmlpp::try_parse_fragment(const std::string& html,
+                             const ParseOptions& options,
+                             myhtmlpp::TAG tag_id, myhtmlpp::NAMESPACE ns) {
+    return to_status(parse_helper(
+        myhtml_parse_fragment, myhtml_parse_chunk_fragment, html, options,
+        static_cast<myhtml_tag_id_t>(tag_id),
+        static_cast<myhtml_namespace_t>(ns)));
+}
+
+myhtmlpp::Executor myhtmlpp::shared_executor() {
+    return [](std::function<void()> job) {
+        ThreadPool::shared().post(std::move(job));
+    };
+}
+
+std::future<myhtmlpp::Tree> myhtmlpp::parse_async(std::string html,
+                                                  ParseOptions options,
+                                                  Executor executor) {
+    // `html` is gone after the job, the tree keeps its own copy
+    options.keep_source = true;
+    options.reuse_engine = true;
+
+    // packaged_task is move-only but std::function needs a copyable job
+    auto task = std::make_shared<std::packaged_task<Tree()>>(
+        [html = std::move(html), options = std::move(options)] {
+            return parse(html, options);
+        });
+    std::future<Tree> future = task->get_future();
+    executor([task] { (*task)(); });
+
+    return future;
+}
+
+std::optional<myhtmlpp::ENCODING>
+myhtmlpp::detect_encoding(std::string_view html) {
+    myencoding_t encoding = MyENCODING_DEFAULT;
+    if (myencoding_detect_bom(html.data(), html.size(), &encoding)) {
+        return static_cast<ENCODING>(encoding);
+    }
+
+    encoding = myencoding_prescan_stream_to_determine_encoding(
+        html.data(), std::min(html.size(), encoding_prescan_size));
+    switch (encoding) {
+        case MyENCODING_NOT_DETERMINED:
+            return std::nullopt;
+        // a document read as UTF-16 could not contain an ASCII meta tag
+        case MyENCODING_UTF_16LE:
+        case MyENCODING_UTF_16BE:
+            return ENCODING::UTF_8;
+        case MyENCODING_X_USER_DEFINED:
+            return ENCODING::WINDOWS_1252;
+        default:
+            return static_cast<ENCODING>(encoding);
+    }
 }
@@ -0,0 +1,194 @@
+#include "myhtmlpp/rewriter.hpp"
+
+#include "elements.hpp"
+#include "markup.hpp"
+#include "myhtmlpp/attribute.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/serialization.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <myhtml/myhtml.h>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using myhtmlpp::append_start_tag;
+
+// the qualified name of `attr` as it is serialized.
+std::string qualified_key(const myhtmlpp::Attribute& attr) {
+    std::string_view key = attr.key_view();
+
+    std::string res(myhtmlpp::attribute_prefix(attr.get_namespace(), key));
+    res.append(key);
+
+    return res;
+}
+
+}  // namespace
+
+myhtmlpp::Rewriter::Rewriter(const Tree& tree) : m_source(tree.source()) {}
+
+void myhtmlpp::Rewriter::set_attribute(const Node& element,
+                                       std::string_view key,
+                                       std::string_view value) {
+    StartTag& tag = start_tag(element);
+
+    auto it = std::find_if(tag.attributes.begin(), tag.attributes.end(),
+                           [&](const auto& attr) { return attr.first == key; });
+    if (it != tag.attributes.end()) {
+        it->second.assign(value.data(), value.size());
+    } else {
+        tag.attributes.emplace_back(key, value);
+    }
+
+    update_start_tag(element, tag);
+}
+
+void myhtmlpp::Rewriter::remove_attribute(const Node& element,
+                                          std::string_view key) {
+    StartTag& tag = start_tag(element);
+
+    tag.attributes.erase(
+        std::remove_if(tag.attributes.begin(), tag.attributes.end(),
+                       [&](const auto& attr) { return attr.first == key; }),
+        tag.attributes.end());
+
+    update_start_tag(element, tag);
+}
+
+void myhtmlpp::Rewriter::replace(const Node& node, std::string_view html) {
+    SourceRange range = range_of(node);
+    m_splices.push_back({range.begin, range.end, std::string(html)});
+}
+
+void myhtmlpp::Rewriter::remove(const Node& node) { replace(node, {}); }
+
+void myhtmlpp::Rewriter::insert_before(const Node& node,
+                                       std::string_view html) {
+    SourceRange range = range_of(node);
+    m_splices.push_back({range.begin, range.begin, std::string(html)});
+}
+
+void myhtmlpp::Rewriter::insert_after(const Node& node,
+                                      std::string_view html) {
+    SourceRange range = range_of(node);
+    m_splices.push_back({range.end, range.end, std::string(html)});
+}
+
+size_t myhtmlpp::Rewriter::size() const { return m_splices.size(); }
+
+std::string myhtmlpp::Rewriter::html() const {
+    std::string res;
+    res.reserve(m_source.size());
+    write_html([&res](std::string_view chunk) { res.append(chunk); });
+
+    return res;
+}
+
+void myhtmlpp::Rewriter::write_html(const Sink& sink) const {
+    // insertions before replacements at the same offset, enclosing
+    // replacements before the ones inside of them, otherwise in the order
+    // of the edits.
+    std::vector<size_t> order(m_splices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        const Splice& a = m_splices[lhs];
+        const Splice& b = m_splices[rhs];
+        if (a.begin != b.begin) {
+            return a.begin < b.begin;
+        }
+
+        bool a_inserts = a.begin == a.end;
+        bool b_inserts = b.begin == b.end;
+        if (a_inserts != b_inserts) {
+            return a_inserts;
+        }
+
+        return a.end > b.end;
+    });
+
+    size_t position = 0;
+    for (size_t i : order) {
+        const Splice& splice = m_splices[i];
+        if (splice.begin < position) {
+            // inside of a replaced range
+            continue;
+        }
+
+        if (splice.begin > position) {
+            sink(m_source.substr(position, splice.begin - position));
+        }
+        if (!splice.text.empty()) {
+            sink(splice.text);
+        }
+        position = splice.end;
+    }
+
+    if (position < m_source.size()) {
+        sink(m_source.substr(position));
+    }
+}
+
+myhtmlpp::SourceRange myhtmlpp::Rewriter::range_of(const Node& node) const {
+    auto range = node.source_range();
+    if (!range || range->end > m_source.size()) {
+        throw std::invalid_argument("node has no range in the source");
+    }
+
+    return range.value();
+}
+
+myhtmlpp::Rewriter::StartTag&
+myhtmlpp::Rewriter::start_tag(const Node& element) {
+    myhtml_tree_node_t* raw_node = RawAccess::node(element);
+    if (auto it = m_start_tags.find(raw_node); it != m_start_tags.end()) {
+        return it->second;
+    }
+
+    myhtml_position_t position =
+        raw_node != nullptr ? myhtml_node_element_position(raw_node)
+                            : myhtml_position_t{0, 0};
+    if (!is_element(element.tag_id()) || position.length == 0 ||
+        position.begin + position.length > m_source.size()) {
+        throw std::invalid_argument("node has no start tag in the source");
+    }
+
+    StartTag tag{m_splices.size(), {}};
+    for (const auto& attr : element.attributes()) {
+        tag.attributes.emplace_back(qualified_key(attr), attr.value_view());
+    }
+
+    m_splices.push_back(
+        {position.begin, position.begin + position.length, std::string()});
+
+    return m_start_tags.emplace(raw_node, std::move(tag)).first->second;
+}
+
+void myhtmlpp::Rewriter::update_start_tag(const Node& element,
+                                          StartTag& tag) {
+    Splice& splice = m_splices[tag.splice];
+    std::string_view original =
+        m_source.substr(splice.begin, splice.end - splice.begin);
+
+    // keep the tag name as it is spelled in the source
+    std::string_view name = original.substr(
+        1, original.find_first_of(" \t\n\r\f/>", 1) - 1);
+    if (name.empty()) {
+        name = element.tag_name_view();
+    }
+
+    bool self_closing = original.size() >= 2 &&
+                        original.substr(original.size() - 2) == "/>";
+
+    splice.text.clear();
+    append_start_tag(splice.text, name, tag.attributes, self_closing);
+}
@@ -0,0 +1,365 @@
+#include "myhtmlpp/selector.hpp"
+
+#include "elements.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "selector_data.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <modest/finder/finder.h>
+#include <mycore/myosi.h>
+#include <mycss/entry.h>
+#include <mycss/mycss.h>
+#include <mycss/selectors/init.h>
+#include <mycss/selectors/list.h>
+#include <mycss/selectors/myosi.h>
+#include <myencoding/myosi.h>
+#include <myhtml/tree.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using myhtmlpp::ATTRIBUTE_MATCH;
+
+std::string lower(std::string_view text) {
+    std::string res(text);
+    std::transform(res.begin(), res.end(), res.begin(), [](char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    });
+
+    return res;
+}
+
+bool equal_ignore_case(std::string_view lhs, std::string_view rhs) {
+    return lhs.size() == rhs.size() && lower(lhs) == lower(rhs);
+}
+
+std::string_view view(const mycore_string_t* string) {
+    return string != nullptr && string->data != nullptr
+               ? std::string_view(string->data, string->length)
+               : std::string_view();
+}
+
+ATTRIBUTE_MATCH to_match(mycss_selectors_match_t match) {
+    switch (match) {
+        case MyCSS_SELECTORS_MATCH_INCLUDE:
+            return ATTRIBUTE_MATCH::INCLUDE;
+        case MyCSS_SELECTORS_MATCH_DASH:
+            return ATTRIBUTE_MATCH::DASH;
+        case MyCSS_SELECTORS_MATCH_PREFIX:
+            return ATTRIBUTE_MATCH::PREFIX;
+        case MyCSS_SELECTORS_MATCH_SUFFIX:
+            return ATTRIBUTE_MATCH::SUFFIX;
+        case MyCSS_SELECTORS_MATCH_SUBSTRING:
+            return ATTRIBUTE_MATCH::SUBSTRING;
+        default:
+            return ATTRIBUTE_MATCH::EQUAL;
+    }
+}
+
+// compiles the entries of one complex selector, returns false if it uses
+// something that is not matched against a path of elements.
+bool compile(mycss_selectors_entry_t* entry,
+             myhtmlpp::ComplexSelector& selector) {
+    for (; entry != nullptr; entry = entry->next) {
+        // the combinator is stored on the first entry after it, entries
+        // without one continue the current compound selector.
+        switch (entry->combinator) {
+            case MyCSS_SELECTORS_COMBINATOR_UNDEF:
+                if (selector.empty()) {
+                    selector.push_back({false, {}, {}});
+                }
+                break;
+            case MyCSS_SELECTORS_COMBINATOR_DESCENDANT:
+                selector.push_back({false, {}, {}});
+                break;
+            case MyCSS_SELECTORS_COMBINATOR_CHILD:
+                selector.push_back({true, {}, {}});
+                break;
+            default:
+                return false;
+        }
+
+        myhtmlpp::CompoundSelector& compound = selector.back();
+        std::string_view key = view(entry->key);
+
+        switch (entry->type) {
+            case MyCSS_SELECTORS_TYPE_ELEMENT:
+                compound.tag_name = key != "*" ? lower(key) : std::string();
+                break;
+            case MyCSS_SELECTORS_TYPE_ID:
+                compound.attributes.push_back(
+                    {"id", std::string(key), ATTRIBUTE_MATCH::EQUAL, false});
+                break;
+            case MyCSS_SELECTORS_TYPE_CLASS:
+                compound.attributes.push_back({"class", std::string(key),
+                                               ATTRIBUTE_MATCH::INCLUDE,
+                                               false});
+                break;
+            case MyCSS_SELECTORS_TYPE_ATTRIBUTE: {
+                auto* attribute =
+                    static_cast<mycss_selectors_object_attribute_t*>(
+                        entry->value);
+                if (attribute == nullptr || attribute->value == nullptr) {
+                    compound.attributes.push_back(
+                        {lower(key), {}, ATTRIBUTE_MATCH::EXISTS, false});
+                } else {
+                    compound.attributes.push_back(
+                        {lower(key), std::string(view(attribute->value)),
+                         to_match(attribute->match),
+                         attribute->mod == MyCSS_SELECTORS_MOD_I});
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return !selector.empty();
+}
+
+// parses `text` with mycss into `data` and compiles it if it is
+// streamable. returns the status of mycss, or invalid_selector_status if
+// mycss reported errors in `text`.
+mystatus_t parse_selector(std::string_view text, myhtmlpp::SelectorData& data) {
+    data.mycss = mycss_create();
+    mystatus_t status = mycss_init(data.mycss);
+    if (status != MyCSS_STATUS_OK) {
+        return status;
+    }
+
+    data.entry = mycss_entry_create();
+    status = mycss_entry_init(data.mycss, data.entry);
+    if (status != MyCSS_STATUS_OK) {
+        return status;
+    }
+
+    data.list = mycss_selectors_parse(mycss_entry_selectors(data.entry),
+                                      MyENCODING_UTF_8, text.data(),
+                                      text.size(), &status);
+    if (status != MyCSS_STATUS_OK) {
+        return status;
+    }
+    if (data.list == nullptr ||
+        (data.list->flags & MyCSS_SELECTORS_FLAGS_SELECTOR_BAD) != 0) {
+        return myhtmlpp::invalid_selector_status;
+    }
+
+    data.streamable = true;
+    for (size_t i = 0; i < data.list->entries_list_length; ++i) {
+        myhtmlpp::ComplexSelector compiled;
+        if (!compile(data.list->entries_list[i].entry, compiled)) {
+            data.streamable = false;
+            data.alternatives.clear();
+            break;
+        }
+
+        data.alternatives.push_back(std::move(compiled));
+    }
+
+    return MyCSS_STATUS_OK;
+}
+
+// an element on the path from the root of a tree, matched like the open
+// elements of a stream.
+struct PathElement {
+    myhtml_tree_node_t* node;
+
+    [[nodiscard]] std::string_view tag_name() const {
+        return myhtmlpp::Node(node).tag_name_view();
+    }
+
+    [[nodiscard]] std::optional<std::string_view>
+    attribute(std::string_view key) const {
+        return myhtmlpp::Node(node).at_view(key);
+    }
+};
+
+}  // namespace
+
+myhtmlpp::SelectorData::~SelectorData() {
+    if (list != nullptr) {
+        mycss_selectors_list_destroy(mycss_entry_selectors(entry), list, true);
+    }
+    if (entry != nullptr) {
+        mycss_entry_destroy(entry, true);
+    }
+    if (mycss != nullptr) {
+        mycss_destroy(mycss, true);
+    }
+}
+
+bool myhtmlpp::satisfies(ATTRIBUTE_MATCH match, std::string_view expected,
+                         bool ignore_case,
+                         std::optional<std::string_view> value) {
+    if (!value) {
+        return false;
+    }
+
+    std::string folded;
+    std::string_view actual = value.value();
+    if (ignore_case) {
+        folded = lower(actual);
+        actual = folded;
+    }
+
+    auto equal = [&](std::string_view lhs, std::string_view rhs) {
+        return ignore_case ? equal_ignore_case(lhs, rhs) : lhs == rhs;
+    };
+
+    switch (match) {
+        case ATTRIBUTE_MATCH::EXISTS:
+            return true;
+        case ATTRIBUTE_MATCH::EQUAL:
+            return equal(actual, expected);
+        case ATTRIBUTE_MATCH::INCLUDE: {
+            if (expected.empty()) {
+                return false;
+            }
+
+            size_t begin = actual.find_first_not_of(" \t\n\r\f");
+            while (begin != std::string_view::npos) {
+                size_t end = actual.find_first_of(" \t\n\r\f", begin);
+                if (equal(actual.substr(begin, end - begin), expected)) {
+                    return true;
+                }
+                begin = actual.find_first_not_of(" \t\n\r\f", end);
+            }
+
+            return false;
+        }
+        case ATTRIBUTE_MATCH::DASH:
+            return equal(actual.substr(0, expected.size()), expected) &&
+                   (actual.size() == expected.size() ||
+                    actual[expected.size()] == '-');
+        case ATTRIBUTE_MATCH::PREFIX:
+            return !expected.empty() && actual.size() >= expected.size() &&
+                   equal(actual.substr(0, expected.size()), expected);
+        case ATTRIBUTE_MATCH::SUFFIX:
+            return !expected.empty() && actual.size() >= expected.size() &&
+                   equal(actual.substr(actual.size() - expected.size()),
+                         expected);
+        case ATTRIBUTE_MATCH::SUBSTRING:
+            if (ignore_case) {
+                return !expected.empty() &&
+                       actual.find(lower(expected)) != std::string_view::npos;
+            }
+            return !expected.empty() &&
+                   actual.find(expected) != std::string_view::npos;
+    }
+
+    return false;
+}
+
+myhtmlpp::Selector::Selector(std::string_view selector)
+    : m_text(selector), m_data(std::make_unique<SelectorData>()) {
+    mystatus_t status = parse_selector(m_text, *m_data);
+    if (status != MyCSS_STATUS_OK) {
+        throw selector_error(status, m_text);
+    }
+}
+
+myhtmlpp::Selector::Selector(std::string_view selector,
+                             std::unique_ptr<SelectorData> data)
+    : m_text(selector), m_data(std::move(data)) {}
+
+myhtmlpp::Result<myhtmlpp::Selector, mystatus_t>
+myhtmlpp::Selector::try_create(std::string_view selector) {
+    auto data = std::make_unique<SelectorData>();
+    mystatus_t status = parse_selector(selector, *data);
+    if (status != MyCSS_STATUS_OK) {
+        return Failure{status};
+    }
+
+    return Selector(selector, std::move(data));
+}
+
+myhtmlpp::Selector::~Selector() = default;
+
+myhtmlpp::Selector::Selector(Selector&& other) noexcept = default;
+
+myhtmlpp::Selector&
+myhtmlpp::Selector::operator=(Selector&& other) noexcept = default;
+
+const std::string& myhtmlpp::Selector::text() const { return m_text; }
+
+bool myhtmlpp::Selector::streamable() const {
+    return m_data && m_data->streamable;
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const Selector& selector) const {
+    const SelectorData* data = RawAccess::selector(selector);
+    if (data == nullptr) {
+        return {};
+    }
+
+    modest_finder_t* finder = modest_finder_create_simple();
+
+    myhtml_collection_t* collection = nullptr;
+    modest_finder_by_selectors_list(finder, m_raw_tree->node_html, data->list,
+                                    &collection);
+
+    std::vector<Node> res;
+    if (collection != nullptr) {
+        res.reserve(collection->length);
+        for (size_t i = 0; i < collection->length; ++i) {
+            res.emplace_back(collection->list[i]);  // NOLINT
+        }
+    }
+
+    myhtml_collection_destroy(collection);
+    modest_finder_destroy(finder, true);
+
+    return res;
+}
+
+myhtmlpp::Result<std::vector<myhtmlpp::Node>, mystatus_t>
+myhtmlpp::Tree::try_select(const std::string& selector) const {
+    auto parsed = Selector::try_create(selector);
+    if (!parsed) {
+        return Failure{parsed.error()};
+    }
+
+    return select(*parsed);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const Selector& selector,
+                       const CancellationToken& token) const {
+    const SelectorData* data = RawAccess::selector(selector);
+    if (data == nullptr || !data->streamable) {
+        token.check();
+        return select(selector);
+    }
+
+    std::vector<Node> res;
+    std::vector<PathElement> path;
+    PeriodicCheck check(token);
+    walk_subtree(
+        m_raw_tree->node_html,
+        [&](myhtml_tree_node_t* node) {
+            check();
+            if (!is_element(static_cast<TAG>(myhtml_node_tag_id(node)))) {
+                return false;
+            }
+
+            path.push_back({node});
+            if (matches(*data, path)) {
+                res.emplace_back(node);
+            }
+
+            return true;
+        },
+        [&](myhtml_tree_node_t* /* node */) { path.pop_back(); });
+
+    return res;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "myhtmlpp/selector.hpp"
+
+#include <cstddef>
+#include <mycss/mycss.h>
+#include <mycss/selectors/myosi.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// An attribute condition of a compound selector, ids and classes are
+/// conditions on the `id` and `class` attributes.
+struct AttributeCondition {
+    std::string key;
+    std::string value;
+    ATTRIBUTE_MATCH match;
+    bool ignore_case;
+};
+
+/// A compound selector, e.g. `a.external[href]`.
+struct CompoundSelector {
+    /// Whether the element must be a child of the element matching the
+    /// compound selector before this one, or just a descendant.
+    bool child;
+
+    /// Lower case tag name, empty for `*`.
+    std::string tag_name;
+
+    std::vector<AttributeCondition> attributes;
+};
+
+/// A complex selector, e.g. `nav > ul a`, from left to right.
+using ComplexSelector = std::vector<CompoundSelector>;
+
+/// A parsed selector: the mycss selector list for Tree::select and, if
+/// possible, a compiled form that is matched against a path of elements.
+struct SelectorData {
+    SelectorData() = default;
+    ~SelectorData();
+
+    SelectorData(const SelectorData&) = delete;
+    SelectorData& operator=(const SelectorData&) = delete;
+
+    mycss_t* mycss = nullptr;
+    mycss_entry_t* entry = nullptr;
+    mycss_selectors_list_t* list = nullptr;
+
+    /// The comma separated selectors.
+    std::vector<ComplexSelector> alternatives;
+
+    /// Whether `alternatives` covers the whole selector.
+    bool streamable = false;
+};
+
+/**
+ * @brief Checks if the attribute value `value` satisfies the condition
+ *        `match` with the expected value `expected`.
+ *
+ * @param value The value, std::nullopt if the attribute does not exist.
+ */
+bool satisfies(ATTRIBUTE_MATCH match, std::string_view expected,
+               bool ignore_case, std::optional<std::string_view> value);
+
+inline bool satisfies(const AttributeCondition& condition,
+                      std::optional<std::string_view> value) {
+    return satisfies(condition.match, condition.value, condition.ignore_case,
+                     value);
+}
+
+// whether `path[index]` matches `selector` from compound `compound` to
+// the left. `path` holds the open elements from the root down, each with
+// `tag_name()` and `attribute(key) -> std::optional<std::string_view>`.
+template <typename Path>
+bool matches_at(const ComplexSelector& selector, size_t compound,
+                const Path& path, size_t index) {
+    const CompoundSelector& current = selector[compound];
+    const auto& element = path[index];
+
+    if (!current.tag_name.empty() && element.tag_name() != current.tag_name) {
+        return false;
+    }
+    for (const auto& condition : current.attributes) {
+        if (!satisfies(condition, element.attribute(condition.key))) {
+            return false;
+        }
+    }
+
+    if (compound == 0) {
+        return true;
+    }
+
+    if (current.child) {
+        return index > 0 && matches_at(selector, compound - 1, path, index - 1);
+    }
+
+    for (size_t ancestor = index; ancestor-- > 0;) {
+        if (matches_at(selector, compound - 1, path, ancestor)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// whether the last element of `path` matches one of the alternatives of
+// the streamable selector `data`.
+template <typename Path>
+bool matches(const SelectorData& data, const Path& path) {
+    if (path.size() == 0) {
+        return false;
+    }
+
+    for (const auto& selector : data.alternatives) {
+        if (!selector.empty() &&
+            matches_at(selector, selector.size() - 1, path, path.size() - 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}  // namespace myhtmlpp
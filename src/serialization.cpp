@@ -0,0 +1,562 @@
+#include "myhtmlpp/serialization.hpp"
+
+#include "elements.hpp"
+#include "markup.hpp"
+#include "myhtmlpp/attribute.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <mycore/myosi.h>
+#include <myhtml/serialization.h>
+#include <myhtml/tree.h>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+
+using myhtmlpp::attribute_prefix;
+using myhtmlpp::closes_paragraph;
+using myhtmlpp::is_block_element;
+using myhtmlpp::is_preformatted;
+using myhtmlpp::is_raw_text;
+using myhtmlpp::NAMESPACE;
+using myhtmlpp::TAG;
+
+// Passed through myhtml to `write_chunk`.
+struct SinkContext {
+    const myhtmlpp::Sink& sink;
+
+    // myhtml ignores the status returned by the callback, so an exception
+    // of the sink is kept here and the remaining chunks are dropped.
+    std::exception_ptr error;
+};
+
+mystatus_t write_chunk(const char* buffer, size_t size, void* ctx) {
+    auto* context = static_cast<SinkContext*>(ctx);
+    if (context->error) {
+        return MyCORE_STATUS_ERROR;
+    }
+
+    // exceptions must not unwind through the myhtml C code
+    try {
+        context->sink(std::string_view(buffer, size));
+    } catch (...) {
+        context->error = std::current_exception();
+        return MyCORE_STATUS_ERROR;
+    }
+
+    return MyCORE_STATUS_OK;
+}
+
+template <typename SerializeFunc>
+void serialize(SerializeFunc f, myhtml_tree_node_t* node,
+               const myhtmlpp::Sink& sink) {
+    if (node == nullptr) {
+        return;
+    }
+
+    SinkContext context{sink, nullptr};
+    mystatus_t status = f(node, write_chunk, &context);
+
+    if (context.error) {
+        std::rethrow_exception(context.error);
+    }
+    if (status != MyCORE_STATUS_OK) {
+        throw myhtmlpp::serialization_error(status);
+    }
+}
+
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+bool is_whitespace_only(std::string_view text) {
+    return std::all_of(text.begin(), text.end(), is_space);
+}
+
+// parents whose whitespace-only text children are never rendered.
+bool ignores_whitespace(TAG tag) {
+    switch (tag) {
+        case TAG::HTML:
+        case TAG::HEAD:
+        case TAG::TABLE:
+        case TAG::THEAD:
+        case TAG::TBODY:
+        case TAG::TFOOT:
+        case TAG::TR:
+        case TAG::COLGROUP:
+        case TAG::UL:
+        case TAG::OL:
+        case TAG::DL:
+        case TAG::SELECT:
+        case TAG::OPTGROUP:
+        case TAG::DATALIST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+TAG tag_of(myhtml_tree_node_t* node) {
+    return static_cast<TAG>(myhtml_node_tag_id(node));
+}
+
+std::string_view text_of(myhtml_tree_node_t* node) {
+    size_t length = 0;
+    const char* text = myhtml_node_text(node, &length);
+
+    return text != nullptr ? std::string_view(text, length)
+                           : std::string_view();
+}
+
+// Serializes a subtree with SerializeOptions, see the HTML fragment
+// serialization algorithm. The output is collected in a small buffer and
+// passed to the sink whenever it is full.
+class Serializer {
+public:
+    Serializer(const myhtmlpp::Sink& sink,
+               const myhtmlpp::SerializeOptions& options)
+        : m_sink(sink), m_options(options) {
+        m_buffer.reserve(buffer_size);
+    }
+
+    void run(myhtml_tree_node_t* root) {
+        walk_subtree(
+            root, [this](myhtml_tree_node_t* node) { return enter(node); },
+            [this](myhtml_tree_node_t* node) { leave(node); });
+
+        flush();
+    }
+
+private:
+    static constexpr size_t buffer_size = 4096;
+
+    bool enter(myhtml_tree_node_t* node) {
+        switch (tag_of(node)) {
+            case TAG::UNDEF_:
+                // the document node
+                return true;
+            case TAG::TEXT_:
+                write_text(node);
+                return false;
+            case TAG::COMMENT_:
+                if (!m_options.drop_comments) {
+                    write("<!--");
+                    write(text_of(node));
+                    write("-->");
+                }
+                return false;
+            case TAG::DOCTYPE_:
+                write_doctype(node);
+                return false;
+            default:
+                break;
+        }
+
+        write_start_tag(node);
+        if (myhtml_node_is_void_element(node)) {
+            return false;
+        }
+
+        TAG tag = tag_of(node);
+        if (is_raw_text(tag)) {
+            ++m_raw_text;
+        }
+        if (is_preformatted(tag)) {
+            ++m_preformatted;
+
+            // the parser drops a line feed right after the start tag
+            myhtml_tree_node_t* child = myhtml_node_child(node);
+            if (tag != TAG::PLAINTEXT && child != nullptr &&
+                tag_of(child) == TAG::TEXT_ &&
+                text_of(child).substr(0, 1) == "\n") {
+                write("\n");
+            }
+        }
+
+        return true;
+    }
+
+    void leave(myhtml_tree_node_t* node) {
+        TAG tag = tag_of(node);
+        if (tag == TAG::UNDEF_) {
+            return;
+        }
+
+        if (is_raw_text(tag)) {
+            --m_raw_text;
+        }
+        if (is_preformatted(tag)) {
+            --m_preformatted;
+        }
+
+        if (m_options.omit_optional_end_tags && end_tag_optional(node)) {
+            return;
+        }
+
+        write("</");
+        write(tag_name(node));
+        write(">");
+    }
+
+    void write_doctype(myhtml_tree_node_t* node) {
+        write("<!DOCTYPE");
+        if (myhtml_tree_attr_t* attr = myhtml_node_attribute_first(node)) {
+            std::string_view name = myhtmlpp::Attribute(attr).key_view();
+            if (!name.empty()) {
+                write(" ");
+                write(name);
+            }
+        }
+        write(">");
+    }
+
+    void write_start_tag(myhtml_tree_node_t* node) {
+        write("<");
+        write(tag_name(node));
+
+        for (myhtml_tree_attr_t* attr = myhtml_node_attribute_first(node);
+             attr != nullptr; attr = myhtml_attribute_next(attr)) {
+            write_attribute(myhtmlpp::Attribute(attr));
+        }
+
+        write(">");
+    }
+
+    void write_attribute(const myhtmlpp::Attribute& attr) {
+        std::string_view key = attr.key_view();
+        const auto& skip = m_options.skip_attributes;
+        if (std::find(skip.begin(), skip.end(), key) != skip.end()) {
+            return;
+        }
+
+        write(" ");
+        write(attribute_prefix(attr.get_namespace(), key));
+        write(key);
+
+        std::string_view value = attr.value_view();
+        if (m_options.omit_optional_quotes) {
+            if (value.empty()) {
+                return;
+            }
+
+            if (value.find_first_of(" \t\n\r\f\"'=<>`") ==
+                std::string_view::npos) {
+                write("=");
+                write_escaped(value, false, false);
+                return;
+            }
+        }
+
+        write("=\"");
+        write_escaped(value, true, false);
+        write("\"");
+    }
+
+    void write_text(myhtml_tree_node_t* node) {
+        std::string_view text = text_of(node);
+        if (m_raw_text > 0) {
+            write(text);
+            return;
+        }
+
+        bool collapse = m_options.collapse_whitespace && m_preformatted == 0;
+        if (collapse && is_whitespace_only(text)) {
+            if (!text.empty() && !dropped_whitespace(node)) {
+                write(" ");
+            }
+            return;
+        }
+
+        write_escaped(text, false, collapse);
+    }
+
+    // escapes `text` and collapses runs of whitespace if `collapse` is set.
+    // unchanged spans are written as they are.
+    void write_escaped(std::string_view text, bool attribute, bool collapse) {
+        size_t span = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            char c = text[i];
+            std::string_view replacement;
+            size_t length = 1;
+
+            if (c == '&') {
+                replacement = "&amp;";
+            } else if (c == '\xC2' && i + 1 < text.size() &&
+                       text[i + 1] == '\xA0') {
+                replacement = "&nbsp;";
+                length = 2;
+            } else if (attribute && c == '"') {
+                replacement = "&quot;";
+            } else if (!attribute && c == '<') {
+                replacement = "&lt;";
+            } else if (!attribute && c == '>') {
+                replacement = "&gt;";
+            } else if (collapse && is_space(c)) {
+                while (i + length < text.size() && is_space(text[i + length])) {
+                    ++length;
+                }
+                if (length == 1 && c == ' ') {
+                    continue;
+                }
+                replacement = " ";
+            } else {
+                continue;
+            }
+
+            write(text.substr(span, i - span));
+            write(replacement);
+            i += length - 1;
+            span = i + 1;
+        }
+
+        write(text.substr(span));
+    }
+
+    // whether the whitespace-only text `node` is dropped when whitespace is
+    // collapsed.
+    bool dropped_whitespace(myhtml_tree_node_t* node) const {
+        myhtml_tree_node_t* parent = myhtml_node_parent(node);
+        if (parent == nullptr) {
+            return true;
+        }
+
+        TAG parent_tag = tag_of(parent);
+        if (ignores_whitespace(parent_tag)) {
+            return true;
+        }
+        if (parent_tag != TAG::BODY && !is_block_element(parent_tag)) {
+            return false;
+        }
+
+        // between blocks and at the start or end of a block
+        auto is_boundary = [](myhtml_tree_node_t* sibling) {
+            return sibling == nullptr || tag_of(sibling) == TAG::COMMENT_ ||
+                   is_block_element(tag_of(sibling));
+        };
+
+        return is_boundary(myhtml_node_prev(node)) &&
+               is_boundary(myhtml_node_next(node));
+    }
+
+    // the next sibling of `node` that is written.
+    myhtml_tree_node_t* next_written(myhtml_tree_node_t* node) const {
+        for (myhtml_tree_node_t* next = myhtml_node_next(node);
+             next != nullptr; next = myhtml_node_next(next)) {
+            TAG tag = tag_of(next);
+            if (tag == TAG::COMMENT_ && m_options.drop_comments) {
+                continue;
+            }
+            if (tag == TAG::TEXT_ && m_options.collapse_whitespace &&
+                m_preformatted == 0 && is_whitespace_only(text_of(next)) &&
+                dropped_whitespace(next)) {
+                continue;
+            }
+
+            return next;
+        }
+
+        return nullptr;
+    }
+
+    // the optional end tags of the HTML standard.
+    bool end_tag_optional(myhtml_tree_node_t* node) const {
+        if (static_cast<NAMESPACE>(myhtml_node_namespace(node)) !=
+            NAMESPACE::HTML) {
+            return false;
+        }
+
+        myhtml_tree_node_t* next = next_written(node);
+        TAG next_tag = next != nullptr ? tag_of(next) : TAG::UNDEF_;
+        bool next_is_element = next != nullptr && next_tag != TAG::TEXT_ &&
+                               next_tag != TAG::COMMENT_;
+
+        switch (tag_of(node)) {
+            case TAG::HTML:
+            case TAG::BODY:
+                return next_tag != TAG::COMMENT_;
+            case TAG::HEAD:
+                return next == nullptr || next_is_element;
+            case TAG::LI:
+                return next == nullptr || next_tag == TAG::LI;
+            case TAG::DT:
+                return next_tag == TAG::DT || next_tag == TAG::DD;
+            case TAG::DD:
+                return next == nullptr || next_tag == TAG::DT ||
+                       next_tag == TAG::DD;
+            case TAG::RT:
+            case TAG::RP:
+                return next == nullptr || next_tag == TAG::RT ||
+                       next_tag == TAG::RP;
+            case TAG::OPTGROUP:
+                return next == nullptr || next_tag == TAG::OPTGROUP;
+            case TAG::OPTION:
+                return next == nullptr || next_tag == TAG::OPTION ||
+                       next_tag == TAG::OPTGROUP;
+            case TAG::THEAD:
+                return next_tag == TAG::TBODY || next_tag == TAG::TFOOT;
+            case TAG::TBODY:
+                return next == nullptr || next_tag == TAG::TBODY ||
+                       next_tag == TAG::TFOOT;
+            case TAG::TFOOT:
+                return next == nullptr;
+            case TAG::TR:
+                return next == nullptr || next_tag == TAG::TR;
+            case TAG::TD:
+            case TAG::TH:
+                return next == nullptr || next_tag == TAG::TD ||
+                       next_tag == TAG::TH;
+            case TAG::P: {
+                if (next != nullptr) {
+                    return next_is_element && closes_paragraph(next_tag);
+                }
+
+                myhtml_tree_node_t* parent = myhtml_node_parent(node);
+                TAG parent_tag = parent != nullptr ? tag_of(parent) : TAG::A;
+
+                // the end tag of a custom element does not close an open p
+                if (parent_tag >= TAG::LAST_ENTRY) {
+                    return false;
+                }
+
+                return parent_tag != TAG::A && parent_tag != TAG::AUDIO &&
+                       parent_tag != TAG::DEL && parent_tag != TAG::INS &&
+                       parent_tag != TAG::MAP && parent_tag != TAG::NOSCRIPT &&
+                       parent_tag != TAG::VIDEO;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static std::string_view tag_name(myhtml_tree_node_t* node) {
+        size_t length = 0;
+        const char* name = myhtml_tag_name_by_id(
+            node->tree, myhtml_node_tag_id(node), &length);
+
+        return name != nullptr ? std::string_view(name, length)
+                               : std::string_view();
+    }
+
+    void write(std::string_view data) {
+        if (m_buffer.size() + data.size() > buffer_size) {
+            flush();
+        }
+
+        if (data.size() >= buffer_size) {
+            m_sink(data);
+        } else {
+            m_buffer.append(data);
+        }
+    }
+
+    void flush() {
+        if (!m_buffer.empty()) {
+            m_sink(m_buffer);
+            m_buffer.clear();
+        }
+    }
+
+    const myhtmlpp::Sink& m_sink;
+    const myhtmlpp::SerializeOptions& m_options;
+    std::string m_buffer;
+
+    // nesting depth of raw text and preformatted elements
+    size_t m_raw_text = 0;
+    size_t m_preformatted = 0;
+};
+
+bool is_default(const myhtmlpp::SerializeOptions& options) {
+    return !options.drop_comments && !options.collapse_whitespace &&
+           !options.omit_optional_quotes && !options.omit_optional_end_tags &&
+           options.skip_attributes.empty();
+}
+
+}  // namespace
+
+myhtmlpp::SerializeOptions myhtmlpp::SerializeOptions::minify() {
+    SerializeOptions options;
+    options.drop_comments = true;
+    options.collapse_whitespace = true;
+    options.omit_optional_quotes = true;
+    options.omit_optional_end_tags = true;
+
+    return options;
+}
+
+myhtmlpp::Sink myhtmlpp::ostream_sink(std::ostream& os) {
+    return [&os](std::string_view chunk) {
+        os.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    };
+}
+
+myhtmlpp::Sink myhtmlpp::fd_sink(int fd) {
+    return [fd](std::string_view chunk) {
+        while (!chunk.empty()) {
+            ssize_t written = ::write(fd, chunk.data(), chunk.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw std::system_error(errno, std::generic_category(),
+                                        "write failed");
+            }
+
+            chunk.remove_prefix(static_cast<size_t>(written));
+        }
+    };
+}
+
+void myhtmlpp::Node::write_html(const Sink& sink) const {
+    serialize(myhtml_serialization_node_callback, m_raw_node, sink);
+}
+
+void myhtmlpp::Node::write_html_deep(const Sink& sink) const {
+    serialize(myhtml_serialization_tree_callback, m_raw_node, sink);
+}
+
+void myhtmlpp::Node::write_html_deep(const Sink& sink,
+                                     const SerializeOptions& options) const {
+    if (is_default(options)) {
+        write_html_deep(sink);
+        return;
+    }
+
+    if (m_raw_node != nullptr) {
+        Serializer(sink, options).run(m_raw_node);
+    }
+}
+
+std::string
+myhtmlpp::Node::html_deep(const SerializeOptions& options) const {
+    std::string res;
+    write_html_deep([&res](std::string_view chunk) { res.append(chunk); },
+                    options);
+
+    return res;
+}
+
+void myhtmlpp::Tree::write_html(const Sink& sink) const {
+    document_node().write_html_deep(sink);
+}
+
+void myhtmlpp::Tree::write_html(const Sink& sink,
+                                const SerializeOptions& options) const {
+    document_node().write_html_deep(sink, options);
+}
+
+std::string myhtmlpp::Tree::html(const SerializeOptions& options) const {
+    return document_node().html_deep(options);
+}
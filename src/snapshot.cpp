@@ -0,0 +1,204 @@
+#include "myhtmlpp/snapshot.hpp"
+
+#include "myhtmlpp/attribute.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <myhtml/tree.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+myhtmlpp::Snapshot::Snapshot(const Node& root) {
+    // attribute strings are collected separately and appended after the
+    // text, so that the text of all nodes is contiguous.
+    std::string attribute_arena;
+
+    // indices of the ancestors of the current node and the node itself
+    std::vector<uint32_t> stack;
+
+    m_text_offsets.push_back(0);
+    m_attribute_offsets.push_back(0);
+
+    walk_subtree(
+        RawAccess::node(root),
+        [&](myhtml_tree_node_t* node) {
+            auto index = static_cast<uint32_t>(m_nodes.size());
+            myhtml_tag_id_t tag = myhtml_node_tag_id(node);
+
+            m_nodes.push_back(node);
+            m_tags.push_back(tag < overflow_tag ? static_cast<uint16_t>(tag)
+                                                : overflow_tag);
+            m_parents.push_back(stack.empty() ? npos : stack.back());
+            m_subtree_ends.push_back(index + 1);
+            m_depths.push_back(static_cast<uint32_t>(stack.size()));
+            stack.push_back(index);
+
+            if (tag == MyHTML_TAG__TEXT || tag == MyHTML_TAG__COMMENT) {
+                size_t length = 0;
+                if (const char* text = myhtml_node_text(node, &length)) {
+                    m_arena.append(text, length);
+                }
+            }
+            m_text_offsets.push_back(static_cast<uint32_t>(m_arena.size()));
+
+            for (myhtml_tree_attr_t* attr = myhtml_node_attribute_first(node);
+                 attr != nullptr; attr = myhtml_attribute_next(attr)) {
+                Attribute attribute(attr);
+                std::string_view key = attribute.key_view();
+                std::string_view value = attribute.value_view();
+
+                AttributeEntry entry{};
+                entry.key_offset =
+                    static_cast<uint32_t>(attribute_arena.size());
+                entry.key_length = static_cast<uint32_t>(key.size());
+                attribute_arena.append(key);
+                entry.value_offset =
+                    static_cast<uint32_t>(attribute_arena.size());
+                entry.value_length = static_cast<uint32_t>(value.size());
+                attribute_arena.append(value);
+
+                m_attributes.push_back(entry);
+            }
+            m_attribute_offsets.push_back(
+                static_cast<uint32_t>(m_attributes.size()));
+
+            return true;
+        },
+        [&](myhtml_tree_node_t* /*node*/) {
+            m_subtree_ends[stack.back()] =
+                static_cast<uint32_t>(m_nodes.size());
+            stack.pop_back();
+        });
+
+    auto base = static_cast<uint32_t>(m_arena.size());
+    m_arena += attribute_arena;
+    for (auto& entry : m_attributes) {
+        entry.key_offset += base;
+        entry.value_offset += base;
+    }
+}
+
+size_t myhtmlpp::Snapshot::size() const { return m_nodes.size(); }
+
+const std::vector<uint16_t>& myhtmlpp::Snapshot::tags() const {
+    return m_tags;
+}
+
+const std::vector<uint32_t>& myhtmlpp::Snapshot::parents() const {
+    return m_parents;
+}
+
+const std::vector<uint32_t>& myhtmlpp::Snapshot::subtree_ends() const {
+    return m_subtree_ends;
+}
+
+const std::vector<uint32_t>& myhtmlpp::Snapshot::depths() const {
+    return m_depths;
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+myhtmlpp::NodeRef myhtmlpp::Snapshot::root() const { return NodeRef{0}; }
+
+myhtmlpp::TAG myhtmlpp::Snapshot::tag_id(NodeRef ref) const {
+    uint16_t tag = m_tags[ref.index];
+    if (tag == overflow_tag) {
+        return static_cast<TAG>(myhtml_node_tag_id(m_nodes[ref.index]));
+    }
+
+    return static_cast<TAG>(tag);
+}
+
+std::optional<myhtmlpp::NodeRef>
+myhtmlpp::Snapshot::parent(NodeRef ref) const {
+    uint32_t parent = m_parents[ref.index];
+
+    return parent != npos ? std::make_optional(NodeRef{parent})
+                          : std::nullopt;
+}
+
+uint32_t myhtmlpp::Snapshot::subtree_end(NodeRef ref) const {
+    return m_subtree_ends[ref.index];
+}
+
+uint32_t myhtmlpp::Snapshot::depth(NodeRef ref) const {
+    return m_depths[ref.index];
+}
+
+std::string_view myhtmlpp::Snapshot::text(NodeRef ref) const {
+    uint32_t begin = m_text_offsets[ref.index];
+    uint32_t end = m_text_offsets[ref.index + 1];
+
+    return std::string_view(m_arena).substr(begin, end - begin);
+}
+
+size_t myhtmlpp::Snapshot::attribute_count(NodeRef ref) const {
+    return m_attribute_offsets[ref.index + 1] - m_attribute_offsets[ref.index];
+}
+
+std::string_view myhtmlpp::Snapshot::attribute_key(NodeRef ref,
+                                                   size_t i) const {
+    const auto& entry = m_attributes[m_attribute_offsets[ref.index] + i];
+
+    return std::string_view(m_arena).substr(entry.key_offset,
+                                            entry.key_length);
+}
+
+std::string_view myhtmlpp::Snapshot::attribute_value(NodeRef ref,
+                                                     size_t i) const {
+    const auto& entry = m_attributes[m_attribute_offsets[ref.index] + i];
+
+    return std::string_view(m_arena).substr(entry.value_offset,
+                                            entry.value_length);
+}
+
+std::optional<std::string_view>
+myhtmlpp::Snapshot::attribute(NodeRef ref, std::string_view key) const {
+    for (size_t i = 0; i < attribute_count(ref); ++i) {
+        if (attribute_key(ref, i) == key) {
+            return attribute_value(ref, i);
+        }
+    }
+
+    return std::nullopt;
+}
+
+myhtmlpp::Node myhtmlpp::Snapshot::node(NodeRef ref) const {
+    return Node(m_nodes[ref.index]);
+}
+
+size_t myhtmlpp::Snapshot::count(TAG tag) const {
+    auto id = static_cast<myhtml_tag_id_t>(tag);
+    if (id >= overflow_tag) {
+        return find_by_tag(tag).size();
+    }
+
+    return static_cast<size_t>(std::count(m_tags.begin(), m_tags.end(),
+                                          static_cast<uint16_t>(id)));
+}
+
+std::vector<myhtmlpp::NodeRef> myhtmlpp::Snapshot::find_by_tag(TAG tag) const {
+    auto id = static_cast<myhtml_tag_id_t>(tag);
+    // all tags from `overflow_tag` on share one column value, those entries
+    // are compared by the tag id of their node.
+    bool overflow = id >= overflow_tag;
+    uint16_t column_id = overflow ? overflow_tag : static_cast<uint16_t>(id);
+
+    std::vector<NodeRef> res;
+    for (size_t i = 0; i < m_tags.size(); ++i) {
+        if (m_tags[i] != column_id) {
+            continue;
+        }
+
+        if (!overflow || myhtml_node_tag_id(m_nodes[i]) == id) {
+            res.push_back(NodeRef{static_cast<uint32_t>(i)});
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,149 @@
+#include "myhtmlpp/static_selector.hpp"
+
+#include "elements.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "selector_data.hpp"
+#include "utils.hpp"
+
+#include <cstddef>
+#include <myhtml/myhtml.h>
+#include <myhtml/tree.h>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using myhtmlpp::TAG;
+
+bool is_element_node(myhtml_tree_node_t* node) {
+    return myhtmlpp::is_element(static_cast<TAG>(myhtml_node_tag_id(node)));
+}
+
+std::optional<std::string_view> attribute_value(myhtml_tree_node_t* node,
+                                                std::string_view key) {
+    myhtml_tree_attr_t* attr =
+        myhtml_attribute_by_key(node, key.data(), key.size());
+    if (attr == nullptr) {
+        return std::nullopt;
+    }
+
+    size_t length = 0;
+    const char* value = myhtml_attribute_value(attr, &length);
+
+    return value != nullptr ? std::string_view(value, length)
+                            : std::string_view();
+}
+
+}  // namespace
+
+bool myhtmlpp::StaticSelector::matches(myhtml_tree_node_t* node) const {
+    size_t first = 0;
+    for (size_t i = 0; i < m_alternative_count; ++i) {
+        size_t end = m_alternative_ends[i];
+        if (matches_at(first, end - 1, node)) {
+            return true;
+        }
+        first = end;
+    }
+
+    return false;
+}
+
+bool myhtmlpp::StaticSelector::matches_at(size_t first, size_t index,
+                                          myhtml_tree_node_t* node) const {
+    const Compound& compound = m_compounds[index];
+    if (!matches_compound(compound, node)) {
+        return false;
+    }
+    if (index == first) {
+        return true;
+    }
+
+    for (myhtml_tree_node_t* ancestor = myhtml_node_parent(node);
+         ancestor != nullptr && is_element_node(ancestor);
+         ancestor = myhtml_node_parent(ancestor)) {
+        if (matches_at(first, index - 1, ancestor)) {
+            return true;
+        }
+        if (compound.child) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool myhtmlpp::StaticSelector::matches_compound(
+    const Compound& compound, myhtml_tree_node_t* node) const {
+    if (!compound.any_tag) {
+        auto tag_id = static_cast<TAG>(myhtml_node_tag_id(node));
+        if (compound.tag_id != TAG::UNDEF_) {
+            if (tag_id != compound.tag_id) {
+                return false;
+            }
+        } else {
+            // custom tags are only known to the tree
+            if (tag_id < TAG::LAST_ENTRY) {
+                return false;
+            }
+
+            size_t length = 0;
+            const char* name = myhtml_tag_name_by_id(
+                node->tree, static_cast<myhtml_tag_id_t>(tag_id), &length);
+            if (name == nullptr ||
+                std::string_view(name, length) != compound.tag_name) {
+                return false;
+            }
+        }
+    }
+
+    for (size_t i = compound.conditions_begin; i < compound.conditions_end;
+         ++i) {
+        const Condition& condition = m_conditions[i];
+        if (!satisfies(condition.match, condition.value, condition.ignore_case,
+                       attribute_value(node, condition.key))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const StaticSelector& selector) const {
+    if (!selector.compiled()) {
+        return select(Selector(selector.text()));
+    }
+
+    std::vector<Node> res;
+    walk_subtree(m_raw_tree->node_html, [&](myhtml_tree_node_t* node) {
+        if (is_element_node(node) && selector.matches(node)) {
+            res.emplace_back(node);
+        }
+    });
+
+    return res;
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const StaticSelector& selector,
+                       const CancellationToken& token) const {
+    if (!selector.compiled()) {
+        return select(Selector(selector.text()), token);
+    }
+
+    std::vector<Node> res;
+    PeriodicCheck check(token);
+    walk_subtree(m_raw_tree->node_html, [&](myhtml_tree_node_t* node) {
+        check();
+        if (is_element_node(node) && selector.matches(node)) {
+            res.emplace_back(node);
+        }
+    });
+
+    return res;
+}
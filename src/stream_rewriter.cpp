@@ -0,0 +1,474 @@
+#include "myhtmlpp/stream_rewriter.hpp"
+
+#include "elements.hpp"
+#include "markup.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/serialization.hpp"
+#include "selector_data.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mycore/myosi.h>
+#include <myencoding/myosi.h>
+#include <myhtml/myhtml.h>
+#include <myhtml/tree.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using myhtmlpp::TAG;
+
+constexpr size_t npos = static_cast<size_t>(-1);
+constexpr size_t buffer_size = 4096;
+
+// whether the start tag `tag` implies the end tag of the open element
+// `open`, the common cases of the tree construction rules.
+bool implies_end_tag(TAG tag, TAG open) {
+    switch (open) {
+        case TAG::P:
+            return myhtmlpp::closes_paragraph(tag);
+        case TAG::LI:
+            return tag == TAG::LI;
+        case TAG::DT:
+        case TAG::DD:
+            return tag == TAG::DT || tag == TAG::DD;
+        case TAG::OPTION:
+            return tag == TAG::OPTION || tag == TAG::OPTGROUP;
+        case TAG::OPTGROUP:
+            return tag == TAG::OPTGROUP;
+        case TAG::RT:
+        case TAG::RP:
+            return tag == TAG::RT || tag == TAG::RP;
+        case TAG::TR:
+            return tag == TAG::TR || tag == TAG::TBODY ||
+                   tag == TAG::TFOOT || tag == TAG::THEAD;
+        case TAG::TD:
+        case TAG::TH:
+            return tag == TAG::TD || tag == TAG::TH || tag == TAG::TR ||
+                   tag == TAG::TBODY || tag == TAG::TFOOT ||
+                   tag == TAG::THEAD;
+        case TAG::THEAD:
+        case TAG::TBODY:
+        case TAG::TFOOT:
+            return tag == TAG::TBODY || tag == TAG::TFOOT ||
+                   tag == TAG::THEAD;
+        default:
+            return false;
+    }
+}
+
+bool is_foreign_root(TAG tag) { return tag == TAG::SVG || tag == TAG::MATH; }
+
+}  // namespace
+
+myhtmlpp::StreamElement::StreamElement(
+    TAG tag_id, std::string_view tag_name,
+    std::vector<std::pair<std::string, std::string>> attributes)
+    : m_tag_id(tag_id), m_tag_name(tag_name),
+      m_attributes(std::move(attributes)) {}
+
+myhtmlpp::TAG myhtmlpp::StreamElement::tag_id() const { return m_tag_id; }
+
+std::string_view myhtmlpp::StreamElement::tag_name() const {
+    return m_tag_name;
+}
+
+std::optional<std::string_view>
+myhtmlpp::StreamElement::attribute(std::string_view key) const {
+    for (const auto& [attr_key, value] : m_attributes) {
+        if (attr_key == key) {
+            return std::string_view(value);
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool myhtmlpp::StreamElement::has_attribute(std::string_view key) const {
+    return attribute(key).has_value();
+}
+
+const std::vector<std::pair<std::string, std::string>>&
+myhtmlpp::StreamElement::attributes() const {
+    return m_attributes;
+}
+
+void myhtmlpp::StreamElement::set_attribute(std::string_view key,
+                                            std::string_view value) {
+    auto it = std::find_if(m_attributes.begin(), m_attributes.end(),
+                           [&](const auto& attr) { return attr.first == key; });
+    if (it != m_attributes.end()) {
+        it->second.assign(value.data(), value.size());
+    } else {
+        m_attributes.emplace_back(key, value);
+    }
+
+    m_attributes_changed = true;
+}
+
+void myhtmlpp::StreamElement::remove_attribute(std::string_view key) {
+    auto it = std::remove_if(
+        m_attributes.begin(), m_attributes.end(),
+        [&](const auto& attr) { return attr.first == key; });
+    if (it != m_attributes.end()) {
+        m_attributes.erase(it, m_attributes.end());
+        m_attributes_changed = true;
+    }
+}
+
+void myhtmlpp::StreamElement::before(std::string_view html) {
+    m_before.append(html);
+}
+
+void myhtmlpp::StreamElement::after(std::string_view html) {
+    m_after.insert(0, html);
+}
+
+void myhtmlpp::StreamElement::prepend(std::string_view html) {
+    m_prepend.insert(0, html);
+}
+
+void myhtmlpp::StreamElement::append(std::string_view html) {
+    m_append.append(html);
+}
+
+void myhtmlpp::StreamElement::set_inner_html(std::string_view html) {
+    m_inner_html.assign(html.data(), html.size());
+    m_inner_replaced = true;
+}
+
+void myhtmlpp::StreamElement::remove() { m_removed = true; }
+
+bool myhtmlpp::StreamElement::removed() const { return m_removed; }
+
+myhtmlpp::StreamRewriter::StreamRewriter(Sink sink)
+    : m_sink(std::move(sink)), m_raw_myhtml(myhtml_create()),
+      m_raw_tree(nullptr), m_suppressed_from(npos) {
+    mystatus_t init_st = myhtml_init(
+        m_raw_myhtml, static_cast<myhtml_options>(OPTION::PARSE_MODE_SINGLE),
+        1, 0);
+    if (init_st != MyHTML_STATUS_OK) {
+        myhtml_destroy(m_raw_myhtml);
+        throw init_error(init_st);
+    }
+
+    m_raw_tree = myhtml_tree_create();
+    mystatus_t tree_st = myhtml_tree_init(m_raw_tree, m_raw_myhtml);
+    if (tree_st != MyHTML_STATUS_OK) {
+        myhtml_tree_destroy(m_raw_tree);
+        myhtml_destroy(m_raw_myhtml);
+        throw tree_init_error(tree_st);
+    }
+
+    // only the tokenizer runs, the tokens are handled in on_token
+    myhtml_tree_parse_flags_set(m_raw_tree,
+                                MyHTML_TREE_PARSE_FLAGS_WITHOUT_BUILD_TREE);
+    myhtml_encoding_set(m_raw_tree, MyENCODING_UTF_8);
+    myhtml_callback_after_token_done_set(m_raw_tree, on_token, this);
+
+    m_buffer.reserve(buffer_size);
+}
+
+myhtmlpp::StreamRewriter::~StreamRewriter() {
+    myhtml_tree_destroy(m_raw_tree);
+    myhtml_destroy(m_raw_myhtml);
+}
+
+void myhtmlpp::StreamRewriter::on(Selector selector, Handler handler) {
+    if (!selector.streamable()) {
+        throw std::invalid_argument("selector \"" + selector.text() +
+                                    "\" can not be matched in a stream");
+    }
+
+    m_handlers.emplace_back(std::move(selector), std::move(handler));
+}
+
+void myhtmlpp::StreamRewriter::on(std::string_view selector,
+                                  Handler handler) {
+    on(Selector(selector), std::move(handler));
+}
+
+void myhtmlpp::StreamRewriter::write(std::string_view chunk) {
+    if (m_ended) {
+        throw std::logic_error("write after end of the stream");
+    }
+    if (chunk.empty()) {
+        return;
+    }
+
+    // myhtml keeps pointing into the chunk until its tokens are done
+    const std::string& data = m_chunks.emplace_back(chunk);
+    m_length += data.size();
+
+    check(myhtml_parse_chunk(m_raw_tree, data.data(), data.size()));
+
+    // release the chunks that are completely written
+    while (!m_chunks.empty() &&
+           m_chunks_offset + m_chunks.front().size() <= m_position) {
+        m_chunks_offset += m_chunks.front().size();
+        m_chunks.pop_front();
+    }
+
+    flush();
+}
+
+void myhtmlpp::StreamRewriter::end() {
+    if (m_ended) {
+        return;
+    }
+    m_ended = true;
+
+    check(myhtml_parse_chunk_end(m_raw_tree));
+
+    copy_to(m_length);
+    while (!m_stack.empty()) {
+        close(std::nullopt);
+    }
+
+    m_chunks.clear();
+    flush();
+}
+
+size_t myhtmlpp::StreamRewriter::depth() const { return m_stack.size(); }
+
+void* myhtmlpp::StreamRewriter::on_token(myhtml_tree_t* /*tree*/,
+                                         myhtml_token_node_t* token,
+                                         void* ctx) {
+    auto* rewriter = static_cast<StreamRewriter*>(ctx);
+
+    // exceptions must not pass through myhtml, they are rethrown by check
+    if (!rewriter->m_error) {
+        try {
+            rewriter->process(token);
+        } catch (...) {
+            rewriter->m_error = std::current_exception();
+        }
+    }
+
+    return ctx;
+}
+
+void myhtmlpp::StreamRewriter::process(myhtml_token_node_t* token) {
+    auto tag = static_cast<TAG>(myhtml_token_node_tag_id(token));
+    switch (tag) {
+        case TAG::UNDEF_:
+        case TAG::TEXT_:
+        case TAG::COMMENT_:
+        case TAG::DOCTYPE_:
+        case TAG::END_OF_FILE:
+            // written as they are with the input before the next tag
+            return;
+        default:
+            break;
+    }
+
+    myhtml_position_t position = myhtml_token_node_element_position(token);
+    if (position.length == 0) {
+        return;
+    }
+
+    size_t begin = std::max(position.begin, m_position);
+    size_t end = std::max(position.begin + position.length, begin);
+    if (myhtml_token_node_is_close(token)) {
+        end_tag(tag, begin, end);
+    } else {
+        start_tag(tag, token, begin, end);
+    }
+}
+
+void myhtmlpp::StreamRewriter::start_tag(TAG tag, myhtml_token_node_t* token,
+                                         size_t begin, size_t end) {
+    copy_to(begin);
+
+    while (!m_stack.empty() && implies_end_tag(tag, m_stack.back().m_tag_id)) {
+        close(std::nullopt);
+    }
+
+    bool self_closing = myhtml_token_node_is_close_self(token);
+    bool has_content =
+        !is_void_element(tag) && !(self_closing && m_foreign_depth > 0);
+
+    size_t name_length = 0;
+    const char* name = myhtml_tag_name_by_id(
+        m_raw_tree, static_cast<myhtml_tag_id_t>(tag), &name_length);
+    std::string_view tag_name =
+        name != nullptr ? std::string_view(name, name_length)
+                        : std::string_view();
+
+    if (m_suppressed_from != npos) {
+        // removed content, only the nesting is tracked
+        copy_to(end);
+        if (has_content) {
+            push(StreamElement(tag, tag_name, {}));
+        }
+        return;
+    }
+
+    std::vector<std::pair<std::string, std::string>> attributes;
+    for (myhtml_tree_attr_t* attr = myhtml_token_node_attribute_first(token);
+         attr != nullptr; attr = myhtml_attribute_next(attr)) {
+        size_t key_length = 0;
+        const char* key = myhtml_attribute_key(attr, &key_length);
+        size_t value_length = 0;
+        const char* value = myhtml_attribute_value(attr, &value_length);
+
+        attributes.emplace_back(
+            key != nullptr ? std::string(key, key_length) : std::string(),
+            value != nullptr ? std::string(value, value_length)
+                             : std::string());
+    }
+
+    push(StreamElement(tag, tag_name, std::move(attributes)));
+    for (auto& [selector, handler] : m_handlers) {
+        if (matches(*RawAccess::selector(selector), m_stack)) {
+            handler(m_stack.back());
+        }
+    }
+
+    StreamElement& element = m_stack.back();
+    emit(element.m_before);
+
+    if (element.m_removed) {
+        m_suppressed_from = m_stack.size() - 1;
+    }
+
+    if (element.m_attributes_changed && !element.m_removed) {
+        std::string start;
+        append_start_tag(start, element.m_tag_name, element.m_attributes,
+                         self_closing);
+        emit(start);
+        m_position = end;
+    } else {
+        copy_to(end);
+    }
+
+    if (!has_content) {
+        close(std::nullopt);
+        return;
+    }
+
+    emit(element.m_prepend);
+    if (element.m_inner_replaced && !element.m_removed) {
+        emit(element.m_inner_html);
+        m_suppressed_from = m_stack.size() - 1;
+    }
+}
+
+void myhtmlpp::StreamRewriter::end_tag(TAG tag, size_t begin, size_t end) {
+    copy_to(begin);
+
+    auto it = std::find_if(
+        m_stack.rbegin(), m_stack.rend(),
+        [&](const StreamElement& element) { return element.m_tag_id == tag; });
+    if (it == m_stack.rend()) {
+        // an end tag without a start tag
+        copy_to(end);
+        return;
+    }
+
+    size_t index = static_cast<size_t>(m_stack.rend() - it) - 1;
+    while (m_stack.size() > index + 1) {
+        close(std::nullopt);
+    }
+
+    close(end);
+}
+
+void myhtmlpp::StreamRewriter::close(std::optional<size_t> end) {
+    StreamElement& element = m_stack.back();
+    bool suppression_root = m_suppressed_from == m_stack.size() - 1;
+
+    // replaced content ends before the end tag, a removed element after
+    if (suppression_root && !element.m_removed) {
+        m_suppressed_from = npos;
+    }
+
+    emit(element.m_append);
+    if (end) {
+        copy_to(end.value());
+    }
+
+    if (suppression_root) {
+        m_suppressed_from = npos;
+    }
+    emit(element.m_after);
+
+    if (is_foreign_root(element.m_tag_id)) {
+        --m_foreign_depth;
+    }
+    m_stack.pop_back();
+}
+
+void myhtmlpp::StreamRewriter::push(StreamElement element) {
+    if (is_foreign_root(element.m_tag_id)) {
+        ++m_foreign_depth;
+    }
+
+    m_stack.push_back(std::move(element));
+}
+
+void myhtmlpp::StreamRewriter::copy_to(size_t offset) {
+    if (offset <= m_position) {
+        return;
+    }
+
+    if (m_suppressed_from == npos) {
+        size_t chunk_begin = m_chunks_offset;
+        for (const std::string& chunk : m_chunks) {
+            size_t chunk_end = chunk_begin + chunk.size();
+            if (chunk_end > m_position) {
+                size_t from = m_position - chunk_begin;
+                size_t to = std::min(offset, chunk_end) - chunk_begin;
+                emit(std::string_view(chunk).substr(from, to - from));
+                m_position = chunk_begin + to;
+            }
+            if (chunk_end >= offset) {
+                break;
+            }
+            chunk_begin = chunk_end;
+        }
+    }
+
+    m_position = offset;
+}
+
+void myhtmlpp::StreamRewriter::emit(std::string_view text) {
+    if (m_suppressed_from != npos || text.empty()) {
+        return;
+    }
+
+    if (m_buffer.size() + text.size() > buffer_size) {
+        flush();
+    }
+
+    if (text.size() >= buffer_size) {
+        m_sink(text);
+    } else {
+        m_buffer.append(text);
+    }
+}
+
+void myhtmlpp::StreamRewriter::flush() {
+    if (!m_buffer.empty()) {
+        m_sink(m_buffer);
+        m_buffer.clear();
+    }
+}
+
+void myhtmlpp::StreamRewriter::check(mystatus_t status) {
+    if (m_error) {
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+    if (status != MyHTML_STATUS_OK) {
+        throw parse_error(status);
+    }
+}
@@ -0,0 +1,664 @@
+#include "myhtmlpp/text.hpp"
+
+#include "elements.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/text_arena.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "text_kernels.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <myhtml/tree.h>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using myhtmlpp::is_block_element;
+using myhtmlpp::is_preformatted;
+using myhtmlpp::TAG;
+
+bool is_cell(TAG tag) { return tag == TAG::TD || tag == TAG::TH; }
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+// U+00A0 in UTF-8
+constexpr char nbsp_lead = '\xC2';
+constexpr char nbsp_trail = '\xA0';
+
+// bytes the kernels stop at, everything else is copied as is.
+bool is_special(char c) { return is_space(c) || c == nbsp_lead; }
+
+// State of one append_normalized call.
+// The output never grows faster than the input is consumed, so `dst` never
+// overtakes the read position and the kernels may store whole blocks as
+// long as the input has a block left after them.
+struct Normalizer {
+    const myhtmlpp::NormalizeOptions& options;
+    char* dst;
+
+    // whitespace is dropped until the next other character
+    bool skip;
+
+    // handles the special byte at `p`, returns the number of consumed bytes.
+    size_t special(const char* p, const char* end) {
+        bool nbsp = false;
+        if (*p == nbsp_lead) {
+            if (!options.nbsp_to_space || end - p < 2 || p[1] != nbsp_trail) {
+                *dst++ = *p;
+                skip = false;
+                return 1;
+            }
+            nbsp = true;
+        }
+
+        size_t length = nbsp ? 2 : 1;
+        if (skip) {
+            return length;
+        }
+
+        if (options.collapse_whitespace) {
+            *dst++ = ' ';
+            skip = true;
+        } else {
+            *dst++ = nbsp ? ' ' : *p;
+        }
+
+        return length;
+    }
+
+    void scalar(const char* p, const char* end) {
+        while (p < end) {
+            if (is_special(*p)) {
+                p += special(p, end);
+            } else {
+                *dst++ = *p++;
+                skip = false;
+            }
+        }
+    }
+};
+
+void normalize_scalar(Normalizer& n, const char* p, const char* end) {
+    n.scalar(p, end);
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MYHTMLPP_X86_KERNELS
+
+// Both kernels classify a block of bytes at once and copy the spans between
+// special bytes with one unaligned load and store each. A span store may
+// write up to one block past the span and a span load may read up to one
+// block past the current one, so the loop stops two blocks before the end;
+// the rest is handled by the scalar loop.
+
+__attribute__((target("sse2"))) void
+normalize_sse2(Normalizer& n, const char* p, const char* end) {
+    constexpr ptrdiff_t width = 16;
+
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i ff = _mm_set1_epi8('\f');
+    const __m128i lead = _mm_set1_epi8(nbsp_lead);
+
+    while (end - p >= 2 * width) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, space),
+                         _mm_cmpeq_epi8(block, tab)),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, lf),
+                             _mm_cmpeq_epi8(block, cr)),
+                _mm_or_si128(_mm_cmpeq_epi8(block, ff),
+                             _mm_cmpeq_epi8(block, lead))));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+
+        if (mask == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(n.dst), block);
+            n.dst += width;
+            p += width;
+            n.skip = false;
+            continue;
+        }
+
+        // `pos` is the first byte of the block that is not handled yet, it
+        // is past the block after a no-break space in the last byte.
+        ptrdiff_t pos = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            ptrdiff_t special_pos = __builtin_ctz(mask);
+            if (special_pos > pos) {
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(n.dst),
+                    _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(p + pos)));
+                n.dst += special_pos - pos;
+                n.skip = false;
+            }
+            pos = special_pos +
+                  static_cast<ptrdiff_t>(n.special(p + special_pos, end));
+        }
+
+        if (pos < width) {
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(n.dst),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + pos)));
+            n.dst += width - pos;
+            n.skip = false;
+            pos = width;
+        }
+
+        p += pos;
+    }
+
+    n.scalar(p, end);
+}
+
+__attribute__((target("avx2"))) void
+normalize_avx2(Normalizer& n, const char* p, const char* end) {
+    constexpr ptrdiff_t width = 32;
+
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i ff = _mm256_set1_epi8('\f');
+    const __m256i lead = _mm256_set1_epi8(nbsp_lead);
+
+    while (end - p >= 2 * width) {
+        __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, space),
+                            _mm256_cmpeq_epi8(block, tab)),
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, lf),
+                                _mm256_cmpeq_epi8(block, cr)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, ff),
+                                _mm256_cmpeq_epi8(block, lead))));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+
+        if (mask == 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(n.dst), block);
+            n.dst += width;
+            p += width;
+            n.skip = false;
+            continue;
+        }
+
+        ptrdiff_t pos = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            ptrdiff_t special_pos = __builtin_ctz(mask);
+            if (special_pos > pos) {
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(n.dst),
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(p + pos)));
+                n.dst += special_pos - pos;
+                n.skip = false;
+            }
+            pos = special_pos +
+                  static_cast<ptrdiff_t>(n.special(p + special_pos, end));
+        }
+
+        if (pos < width) {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(n.dst),
+                _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(p + pos)));
+            n.dst += width - pos;
+            n.skip = false;
+            pos = width;
+        }
+
+        p += pos;
+    }
+
+    n.scalar(p, end);
+}
+
+// Substring search kernels, see find_substring. `needle` has at least two
+// bytes. Positions whose first and last byte match the needle are compared
+// in full, the search continues with the scalar find for the last bytes.
+
+__attribute__((target("sse2"))) size_t
+find_sse2(std::string_view haystack, std::string_view needle, size_t pos) {
+    constexpr size_t width = 16;
+
+    const size_t last = needle.size() - 1;
+    const __m128i first_byte = _mm_set1_epi8(needle.front());
+    const __m128i last_byte = _mm_set1_epi8(needle.back());
+    const char* data = haystack.data();
+
+    for (; pos + last + width <= haystack.size(); pos += width) {
+        __m128i first_block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i last_block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(data + pos + last));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first_block, first_byte),
+                          _mm_cmpeq_epi8(last_block, last_byte))));
+
+        for (; mask != 0; mask &= mask - 1) {
+            size_t candidate = pos + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(data + candidate + 1, needle.data() + 1,
+                            last - 1) == 0) {
+                return candidate;
+            }
+        }
+    }
+
+    return haystack.find(needle, pos);
+}
+
+__attribute__((target("avx2"))) size_t
+find_avx2(std::string_view haystack, std::string_view needle, size_t pos) {
+    constexpr size_t width = 32;
+
+    const size_t last = needle.size() - 1;
+    const __m256i first_byte = _mm256_set1_epi8(needle.front());
+    const __m256i last_byte = _mm256_set1_epi8(needle.back());
+    const char* data = haystack.data();
+
+    for (; pos + last + width <= haystack.size(); pos += width) {
+        __m256i first_block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i last_block = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(data + pos + last));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first_block, first_byte),
+                             _mm256_cmpeq_epi8(last_block, last_byte))));
+
+        for (; mask != 0; mask &= mask - 1) {
+            size_t candidate = pos + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(data + candidate + 1, needle.data() + 1,
+                            last - 1) == 0) {
+                return candidate;
+            }
+        }
+    }
+
+    return haystack.find(needle, pos);
+}
+
+#endif
+
+using Kernel = void (*)(Normalizer&, const char*, const char*);
+
+Kernel normalize_kernel(myhtmlpp::KERNEL kernel) {
+    switch (kernel) {
+#ifdef MYHTMLPP_X86_KERNELS
+        case myhtmlpp::KERNEL::AVX2:
+            return normalize_avx2;
+        case myhtmlpp::KERNEL::SSE2:
+            return normalize_sse2;
+#endif
+        default:
+            return normalize_scalar;
+    }
+}
+
+void normalize_with(Kernel kernel, std::string& out, std::string_view text,
+                    const myhtmlpp::NormalizeOptions& options) {
+    bool after_space = out.empty() || is_space(out.back());
+
+    // the normalized text is never longer than `text`
+    size_t base = out.size();
+    out.resize(base + text.size());
+
+    Normalizer n{options, out.data() + base,
+                 options.trim || (options.collapse_whitespace && after_space)};
+    kernel(n, text.data(), text.data() + text.size());
+
+    char* begin = out.data() + base;
+    if (options.trim) {
+        while (n.dst > begin && is_space(n.dst[-1])) {
+            --n.dst;
+        }
+    }
+
+    out.resize(static_cast<size_t>(n.dst - out.data()));
+}
+
+size_t find_scalar(std::string_view haystack, std::string_view needle,
+                   size_t pos) {
+    return haystack.find(needle, pos);
+}
+
+using SearchKernel = size_t (*)(std::string_view, std::string_view, size_t);
+
+SearchKernel search_kernel(myhtmlpp::KERNEL kernel) {
+    switch (kernel) {
+#ifdef MYHTMLPP_X86_KERNELS
+        case myhtmlpp::KERNEL::AVX2:
+            return find_avx2;
+        case myhtmlpp::KERNEL::SSE2:
+            return find_sse2;
+#endif
+        default:
+            return find_scalar;
+    }
+}
+
+size_t find_with(SearchKernel kernel, std::string_view haystack,
+                 std::string_view needle, size_t pos) {
+    if (needle.size() < 2 || pos >= haystack.size()) {
+        // memchr is vectorized already
+        return haystack.find(needle, pos);
+    }
+
+    return kernel(haystack, needle, pos);
+}
+
+// returns the deepest node that contains both `first` and `last`.
+myhtml_tree_node_t* common_ancestor(myhtml_tree_node_t* first,
+                                    myhtml_tree_node_t* last) {
+    std::vector<myhtml_tree_node_t*> ancestors;
+    for (auto* node = first; node != nullptr; node = myhtml_node_parent(node)) {
+        ancestors.push_back(node);
+    }
+
+    for (auto* node = last; node != nullptr; node = myhtml_node_parent(node)) {
+        if (std::find(ancestors.begin(), ancestors.end(), node) !=
+            ancestors.end()) {
+            return node;
+        }
+    }
+
+    return nullptr;
+}
+
+// Appends the visible text of one subtree to `out`, everything before
+// `start` belongs to the caller.
+class VisibleTextWriter {
+public:
+    VisibleTextWriter(std::string& out,
+                      const myhtmlpp::VisibleTextOptions& options)
+        : m_out(out), m_options(options), m_start(out.size()) {}
+
+    // returns false if the subtree of the element should be skipped.
+    bool enter(TAG tag) {
+        if (std::find(m_options.skip_tags.begin(), m_options.skip_tags.end(),
+                      tag) != m_options.skip_tags.end()) {
+            return false;
+        }
+
+        if (tag == TAG::BR) {
+            if (m_options.block_newlines) {
+                if (m_out.size() > m_start && m_out.back() == ' ') {
+                    m_out.pop_back();
+                }
+                if (m_out.size() > m_start) {
+                    m_out += '\n';
+                }
+            } else {
+                space();
+            }
+        } else if (is_block_element(tag)) {
+            block_boundary();
+        }
+
+        if (is_preformatted(tag)) {
+            ++m_preformatted;
+        }
+
+        return true;
+    }
+
+    void leave(TAG tag) {
+        if (is_preformatted(tag)) {
+            --m_preformatted;
+        }
+
+        if (is_block_element(tag)) {
+            block_boundary();
+        } else if (is_cell(tag)) {
+            space();
+        }
+    }
+
+    void text(std::string_view text) {
+        if (!m_options.collapse_whitespace || m_preformatted > 0) {
+            m_out.append(text);
+            return;
+        }
+
+        size_t size = m_out.size();
+        myhtmlpp::append_normalized(m_out, text, m_normalize);
+
+        // append_normalized only drops leading whitespace after whitespace
+        if (size == m_start && m_out.size() > size && m_out[size] == ' ') {
+            m_out.erase(size, 1);
+        }
+    }
+
+    // drops the whitespace after the last line.
+    void finish() {
+        while (m_out.size() > m_start &&
+               (m_out.back() == '\n' || m_out.back() == ' ')) {
+            m_out.pop_back();
+        }
+    }
+
+private:
+    bool at_line_start() const {
+        return m_out.size() == m_start || m_out.back() == '\n';
+    }
+
+    void space() {
+        if (!at_line_start() && m_out.back() != ' ') {
+            m_out += ' ';
+        }
+    }
+
+    // separates the text of a block element from the text around it.
+    void block_boundary() {
+        if (m_options.block_newlines) {
+            line_break();
+        } else {
+            space();
+        }
+    }
+
+    // ends the current line, without whitespace at its end.
+    void line_break() {
+        if (m_out.size() > m_start && m_out.back() == ' ') {
+            m_out.pop_back();
+        }
+        if (!at_line_start()) {
+            m_out += '\n';
+        }
+    }
+
+    std::string& m_out;
+    const myhtmlpp::VisibleTextOptions& m_options;
+    size_t m_start;
+
+    // nesting depth of elements that keep their whitespace
+    size_t m_preformatted = 0;
+
+    // collapses whitespace, leading and trailing whitespace of a text node
+    // may separate it from its neighbours
+    myhtmlpp::NormalizeOptions m_normalize{true, false, true};
+};
+
+}  // namespace
+
+bool myhtmlpp::kernel_supported(KERNEL kernel) {
+    switch (kernel) {
+        case KERNEL::SCALAR:
+            return true;
+#ifdef MYHTMLPP_X86_KERNELS
+        case KERNEL::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case KERNEL::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+myhtmlpp::KERNEL myhtmlpp::best_kernel() {
+    for (KERNEL kernel : {KERNEL::AVX2, KERNEL::SSE2}) {
+        if (kernel_supported(kernel)) {
+            return kernel;
+        }
+    }
+
+    return KERNEL::SCALAR;
+}
+
+void myhtmlpp::append_normalized(std::string& out, std::string_view text,
+                                 const NormalizeOptions& options) {
+    static const Kernel kernel = normalize_kernel(best_kernel());
+
+    normalize_with(kernel, out, text, options);
+}
+
+void myhtmlpp::append_normalized(std::string& out, std::string_view text,
+                                 const NormalizeOptions& options,
+                                 KERNEL kernel) {
+    normalize_with(normalize_kernel(kernel), out, text, options);
+}
+
+std::string myhtmlpp::normalize_text(std::string_view text,
+                                     const NormalizeOptions& options) {
+    std::string res;
+    append_normalized(res, text, options);
+
+    return res;
+}
+
+std::string
+myhtmlpp::Node::visible_text(const VisibleTextOptions& options) const {
+    std::string res;
+    visible_text_into(res, options);
+
+    return res;
+}
+
+void myhtmlpp::Node::visible_text_into(
+    std::string& out, const VisibleTextOptions& options) const {
+    VisibleTextWriter writer(out, options);
+
+    auto enter = [&](myhtml_tree_node_t* node) {
+        auto tag = static_cast<TAG>(myhtml_node_tag_id(node));
+        if (tag == TAG::TEXT_) {
+            size_t length = 0;
+            if (const char* text = myhtml_node_text(node, &length)) {
+                writer.text(std::string_view(text, length));
+            }
+
+            return false;
+        }
+
+        if (tag == TAG::COMMENT_ || tag == TAG::DOCTYPE_) {
+            return false;
+        }
+
+        return writer.enter(tag);
+    };
+
+    auto leave = [&](myhtml_tree_node_t* node) {
+        writer.leave(static_cast<TAG>(myhtml_node_tag_id(node)));
+    };
+
+    walk_subtree(RawAccess::node(*this), enter, leave);
+
+    writer.finish();
+}
+
+size_t myhtmlpp::find_substring(std::string_view haystack,
+                                std::string_view needle, size_t pos) {
+    static const SearchKernel kernel = search_kernel(best_kernel());
+
+    return find_with(kernel, haystack, needle, pos);
+}
+
+size_t myhtmlpp::find_substring(std::string_view haystack,
+                                std::string_view needle, size_t pos,
+                                KERNEL kernel) {
+    return find_with(search_kernel(kernel), haystack, needle, pos);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_text(std::string_view needle, TEXT_SEARCH mode) const {
+    return find_text(needle, document_node(), mode);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_text(std::string_view needle, const Node& scope_node,
+                          TEXT_SEARCH mode) const {
+    std::vector<Node> res;
+    if (needle.empty()) {
+        return res;
+    }
+
+    if (mode == TEXT_SEARCH::TEXT_NODES) {
+        auto visit = [&](myhtml_tree_node_t* node) {
+            if (myhtml_node_tag_id(node) != MyHTML_TAG__TEXT) {
+                return;
+            }
+
+            size_t length = 0;
+            const char* text = myhtml_node_text(node, &length);
+            if (text != nullptr &&
+                find_substring(std::string_view(text, length), needle) !=
+                    std::string_view::npos) {
+                res.emplace_back(node);
+            }
+        };
+        walk_subtree(RawAccess::node(scope_node), visit);
+
+        return res;
+    }
+
+    return TextArena(scope_node).find_elements(needle);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::TextArena::find_elements(std::string_view needle) const {
+    std::vector<Node> res;
+    if (needle.empty()) {
+        return res;
+    }
+
+    std::string_view text = m_text;
+
+    std::unordered_set<myhtml_tree_node_t*> found;
+    for (size_t pos = find_substring(text, needle);
+         pos != std::string_view::npos;
+         pos = find_substring(text, needle, pos + 1)) {
+        size_t first = index_at(pos).value();
+        size_t last = index_at(pos + needle.size() - 1).value();
+
+        myhtml_tree_node_t* element =
+            common_ancestor(m_nodes[first], m_nodes[last]);
+        if (element != m_root &&
+            myhtml_node_tag_id(element) == MyHTML_TAG__TEXT) {
+            element = myhtml_node_parent(element);
+        }
+
+        if (found.insert(element).second) {
+            res.emplace_back(element);
+        }
+    }
+
+    return res;
+}
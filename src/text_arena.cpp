@@ -0,0 +1,102 @@
+#include "myhtmlpp/text_arena.hpp"
+
+#include "myhtmlpp/node.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <myhtml/tree.h>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+myhtmlpp::TextArena::TextArena(const Node& root)
+    : m_root(RawAccess::node(root)) {
+    // measure first, so the text is copied into its final buffer once
+    size_t length = 0;
+    size_t count = 0;
+    root.for_each_text([&](std::string_view text) {
+        length += text.size();
+        ++count;
+    });
+
+    m_text.reserve(length);
+    m_nodes.reserve(count);
+    m_offsets.reserve(count + 1);
+
+    m_offsets.push_back(0);
+    walk_subtree(m_root, [&](myhtml_tree_node_t* node) {
+        if (myhtml_node_tag_id(node) != MyHTML_TAG__TEXT) {
+            return;
+        }
+
+        size_t text_length = 0;
+        const char* text = myhtml_node_text(node, &text_length);
+        if (text == nullptr) {
+            return;
+        }
+
+        m_text.append(text, text_length);
+        m_nodes.push_back(node);
+        m_offsets.push_back(static_cast<uint32_t>(m_text.size()));
+    });
+}
+
+myhtmlpp::Node myhtmlpp::TextArena::root() const { return Node(m_root); }
+
+std::string_view myhtmlpp::TextArena::text() const { return m_text; }
+
+size_t myhtmlpp::TextArena::size() const { return m_nodes.size(); }
+
+myhtmlpp::Node myhtmlpp::TextArena::node(size_t i) const {
+    return Node(m_nodes[i]);
+}
+
+size_t myhtmlpp::TextArena::offset(size_t i) const { return m_offsets[i]; }
+
+std::string_view myhtmlpp::TextArena::text(size_t i) const {
+    return std::string_view(m_text).substr(m_offsets[i],
+                                           m_offsets[i + 1] - m_offsets[i]);
+}
+
+std::optional<size_t> myhtmlpp::TextArena::index_at(size_t offset) const {
+    if (offset >= m_text.size()) {
+        return std::nullopt;
+    }
+
+    // the first node that ends after `offset`, empty text nodes end where
+    // they start and are skipped.
+    auto it = std::upper_bound(m_offsets.begin() + 1, m_offsets.end(),
+                               static_cast<uint32_t>(offset));
+
+    return static_cast<size_t>(it - m_offsets.begin()) - 1;
+}
+
+std::optional<myhtmlpp::Node>
+myhtmlpp::TextArena::node_at(size_t offset) const {
+    if (auto index = index_at(offset)) {
+        return node(index.value());
+    }
+
+    return std::nullopt;
+}
+
+std::vector<myhtmlpp::Node> myhtmlpp::TextArena::nodes_in(size_t begin,
+                                                          size_t end) const {
+    std::vector<Node> res;
+
+    end = std::min(end, m_text.size());
+    if (begin >= end) {
+        return res;
+    }
+
+    for (size_t i = index_at(begin).value();
+         i < m_nodes.size() && m_offsets[i] < end; ++i) {
+        if (m_offsets[i + 1] > m_offsets[i]) {
+            res.push_back(node(i));
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "myhtmlpp/text.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace myhtmlpp {
+
+/// The instruction sets of the text kernels.
+enum class KERNEL : unsigned int {
+    SCALAR = 0x00,
+    SSE2 = 0x01,
+    AVX2 = 0x02
+};
+
+/**
+ * @brief Checks if `kernel` can run on this CPU.
+ *
+ * The scalar kernel runs everywhere, the SSE2 and AVX2 kernels only on x86
+ * CPUs supporting the instruction set.
+ */
+[[nodiscard]] bool kernel_supported(KERNEL kernel);
+
+/**
+ * @brief Returns the fastest kernel that can run on this CPU, the kernel
+ *        append_normalized and find_substring use.
+ */
+[[nodiscard]] KERNEL best_kernel();
+
+/**
+ * @brief Appends the normalized `text` to `out` with the kernel `kernel`,
+ *        which must be supported.
+ *
+ * @see append_normalized
+ */
+void append_normalized(std::string& out, std::string_view text,
+                       const NormalizeOptions& options, KERNEL kernel);
+
+/**
+ * @brief Finds `needle` in `haystack` at or after `pos` with the kernel
+ *        `kernel`, which must be supported.
+ *
+ * @see find_substring
+ */
+[[nodiscard]] size_t find_substring(std::string_view haystack,
+                                    std::string_view needle, size_t pos,
+                                    KERNEL kernel);
+
+}  // namespace myhtmlpp
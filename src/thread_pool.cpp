@@ -0,0 +1,67 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+myhtmlpp::ThreadPool::ThreadPool(size_t thread_count) {
+    thread_count = std::max<size_t>(thread_count, 1);
+
+    m_threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_threads.emplace_back([this] { work(); });
+    }
+}
+
+myhtmlpp::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void myhtmlpp::ThreadPool::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+
+    m_cv.notify_one();
+}
+
+size_t myhtmlpp::ThreadPool::size() const { return m_threads.size(); }
+
+myhtmlpp::ThreadPool& myhtmlpp::ThreadPool::shared() {
+    static ThreadPool pool(std::thread::hardware_concurrency());
+
+    return pool;
+}
+
+void myhtmlpp::ThreadPool::work() {
+    while (true) {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+            if (m_jobs.empty()) {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
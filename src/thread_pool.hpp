@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// A fixed size pool of worker threads executing posted jobs in FIFO order.
+class ThreadPool {
+public:
+    /**
+     * @brief ThreadPool constructor.
+     *
+     * Starts `thread_count` worker threads; at least one thread is started.
+     */
+    explicit ThreadPool(size_t thread_count);
+
+    /**
+     * @brief ThreadPool destructor.
+     *
+     * Runs all jobs that are still queued and joins the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    /**
+     * @brief Queues `job` for execution on one of the worker threads.
+     *
+     * `job` must not throw; an exception escaping it terminates the
+     * program, report errors through the state the job shares instead.
+     */
+    void post(std::function<void()> job);
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * @brief Returns the pool shared by the library.
+     *
+     * The pool is created on first use with one thread per hardware thread.
+     */
+    static ThreadPool& shared();
+
+private:
+    void work();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+};
+
+}  // namespace myhtmlpp
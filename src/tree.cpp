@@ -1,55 +1,82 @@
 #include "myhtmlpp/tree.hpp"
 
+#include "engine_pool.hpp"
 #include "myhtmlpp/constants.hpp"
 #include "myhtmlpp/node.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/snapshot.hpp"
+#include "myhtmlpp/tag_names.hpp"
+#include "myhtmlpp/text_arena.hpp"
+#include "tree_info.hpp"
+#include "utils.hpp"
 
 #include <algorithm>
-#include <cstring>
+#include <functional>
 #include <iterator>
-#include <modest/finder/finder.h>
-#include <modest/finder/myosi.h>
+#include <memory>
 #include <mycore/myosi.h>
-#include <mycore/mystring.h>
-#include <mycss/entry.h>
-#include <mycss/mycss.h>
-#include <mycss/myosi.h>
-#include <mycss/selectors/init.h>
-#include <mycss/selectors/list.h>
-#include <mycss/selectors/myosi.h>
 #include <myencoding/myosi.h>
-#include <myhtml/serialization.h>
 #include <myhtml/tree.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+namespace {
+
+// returns the myhtml instance of a tree to the engine pool if it was
+// borrowed from there, destroys it otherwise.
+void release_myhtml(myhtml_t* raw_myhtml, const myhtmlpp::TreeInfo* info) {
+    if (info != nullptr && info->pooled_engine()) {
+        myhtmlpp::EnginePool::shared().release(raw_myhtml);
+    } else {
+        myhtml_destroy(raw_myhtml);
+    }
+}
+
+}  // namespace
+
 myhtmlpp::Tree::Tree(myhtml_t* raw_myhtml, myhtml_tree_t* raw_tree)
-    : m_raw_myhtml(raw_myhtml), m_raw_tree(raw_tree) {}
+    : m_raw_myhtml(raw_myhtml), m_raw_tree(raw_tree),
+      m_info(std::make_unique<TreeInfo>()) {}
 
 myhtmlpp::Tree::~Tree() {
+    if (m_info && m_raw_tree != nullptr) {
+        m_info->clear_order_index(m_raw_tree);
+    }
+
     myhtml_tree_destroy(m_raw_tree);
-    myhtml_destroy(m_raw_myhtml);
+    if (m_raw_myhtml != nullptr) {
+        release_myhtml(m_raw_myhtml, m_info.get());
+    }
 }
 
 myhtmlpp::Tree::Tree(Tree&& other) noexcept
-    : m_raw_myhtml(other.m_raw_myhtml), m_raw_tree(other.m_raw_tree) {
+    : m_raw_myhtml(other.m_raw_myhtml), m_raw_tree(other.m_raw_tree),
+      m_info(std::move(other.m_info)) {
     other.m_raw_tree = nullptr;
     other.m_raw_myhtml = nullptr;
 }
 
 myhtmlpp::Tree& myhtmlpp::Tree::operator=(Tree&& other) noexcept {
     // if the tree is not empty and the other tree is different
-    // we have to release the resources of the tree.
-    if (m_raw_myhtml != nullptr && m_raw_myhtml != other.m_raw_myhtml) {
-        myhtml_destroy(m_raw_myhtml);
-    }
-
+    // we have to release the resources of the tree. the tree goes first,
+    // a pooled myhtml instance may be used by another parse right after.
     if (m_raw_tree != nullptr && m_raw_tree != other.m_raw_tree) {
+        if (m_info) {
+            m_info->clear_order_index(m_raw_tree);
+        }
+
         myhtml_tree_destroy(m_raw_tree);
     }
 
+    if (m_raw_myhtml != nullptr && m_raw_myhtml != other.m_raw_myhtml) {
+        release_myhtml(m_raw_myhtml, m_info.get());
+    }
+
     m_raw_myhtml = other.m_raw_myhtml;
     m_raw_tree = other.m_raw_tree;
+    m_info = std::move(other.m_info);
 
     other.m_raw_myhtml = nullptr;
     other.m_raw_tree = nullptr;
@@ -65,6 +92,16 @@ myhtmlpp::Node myhtmlpp::Tree::document_node() const {
     return Node(myhtml_tree_get_document(m_raw_tree));
 }
 
+std::string_view myhtmlpp::Tree::source() const {
+    return m_raw_tree != nullptr ? source_of(m_raw_tree) : std::string_view();
+}
+
+myhtmlpp::ENCODING myhtmlpp::Tree::encoding() const {
+    return m_raw_tree != nullptr
+               ? static_cast<ENCODING>(myhtml_encoding_get(m_raw_tree))
+               : ENCODING::UTF_8;
+}
+
 myhtmlpp::Node myhtmlpp::Tree::html_node() const {
     return Node(myhtml_tree_get_node_html(m_raw_tree));
 }
@@ -78,63 +115,50 @@ myhtmlpp::Node myhtmlpp::Tree::body_node() const {
 }
 
 std::string myhtmlpp::Tree::html() const {
-    mycore_string_raw_t str = {nullptr, 0, 0};
-    myhtml_serialization_tree_buffer(myhtml_tree_get_document(m_raw_tree),
-                                     &str);
-
-    std::string res = str.data != nullptr ? str.data : "";
-
-    mycore_string_raw_destroy(&str, false);
+    std::string res;
+    write_html([&res](std::string_view chunk) { res.append(chunk); });
 
     return res;
 }
 
-std::vector<myhtmlpp::Node>
-myhtmlpp::Tree::select(const std::string& selector) const {
-    mycss_t* mycss = mycss_create();
-    mystatus_t status = mycss_init(mycss);
-    if (status != MyCSS_STATUS_OK) {
-        return {};
-    }
-
-    mycss_entry_t* entry = mycss_entry_create();
-    status = mycss_entry_init(mycss, entry);
-    if (status != MyCSS_STATUS_OK) {
-        return {};
-    }
-
-    modest_finder_t* finder = modest_finder_create_simple();
-
-    mycss_selectors_list_t* list = mycss_selectors_parse(
-        mycss_entry_selectors(entry), MyENCODING_UTF_8, selector.c_str(),
-        strlen(selector.c_str()), &status);
-    if (status != MyCSS_STATUS_OK) {
-        return {};
-    }
+void myhtmlpp::Tree::build_order_index() {
+    m_info->build_order_index(m_raw_tree);
+}
 
-    myhtml_collection_t* collection = nullptr;
-    modest_finder_by_selectors_list(finder, m_raw_tree->node_html, list,
-                                    &collection);
+void myhtmlpp::Tree::clear_order_index() {
+    m_info->clear_order_index(m_raw_tree);
+}
 
-    std::vector<Node> res;
-    res.reserve(collection->length);
+bool myhtmlpp::Tree::has_order_index() const {
+    return m_info && m_info->has_order_index();
+}
 
-    if (collection != nullptr) {
-        for (size_t i = 0; i < collection->length; ++i) {
-            res.emplace_back(collection->list[i]);  // NOLINT
-        }
-    }
+myhtmlpp::Snapshot myhtmlpp::Tree::snapshot() const {
+    return Snapshot(document_node());
+}
 
-    myhtml_collection_destroy(collection);
+myhtmlpp::Snapshot myhtmlpp::Tree::snapshot(const Node& scope_node) const {
+    return Snapshot(scope_node);
+}
 
-    mycss_selectors_list_destroy(mycss_entry_selectors(entry), list, true);
+myhtmlpp::TextArena myhtmlpp::Tree::text_arena() const {
+    return TextArena(document_node());
+}
 
-    modest_finder_destroy(finder, true);
+myhtmlpp::TextArena
+myhtmlpp::Tree::text_arena(const Node& scope_node) const {
+    return TextArena(scope_node);
+}
 
-    mycss_entry_destroy(entry, true);
-    mycss_destroy(mycss, true);
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const std::string& selector) const {
+    return select(Selector(selector));
+}
 
-    return res;
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::select(const std::string& selector,
+                       const CancellationToken& token) const {
+    return select(Selector(selector), token);
 }
 
 std::vector<myhtmlpp::Node>
@@ -145,12 +169,30 @@ myhtmlpp::Tree::find_by_tag(const std::string& tag) const {
 std::vector<myhtmlpp::Node>
 myhtmlpp::Tree::find_by_tag(const std::string& tag,
                             const Node& scope_node) const {
+    // known names are compared by id, only custom tags by name
+    TAG tag_id = tag_from_name(tag);
+    if (tag_id != TAG::UNDEF_) {
+        return find_by_tag(tag_id, scope_node);
+    }
+
     std::vector<Node> res;
     std::copy_if(ConstIterator(scope_node), end(), std::back_inserter(res),
-                 [&](const auto& node) { return node.tag_name() == tag; });
+                 [&](const auto& node) { return node.tag_name_view() == tag; });
 
     return res;
 }
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_by_tag(const std::string& tag,
+                            const CancellationToken& token) const {
+    TAG tag_id = tag_from_name(tag);
+    if (tag_id != TAG::UNDEF_) {
+        return find_by_tag(tag_id, token);
+    }
+
+    return collect(
+        [&](const Node& node) { return node.tag_name_view() == tag; }, token);
+}
+
 std::vector<myhtmlpp::Node>
 myhtmlpp::Tree::find_by_tag(myhtmlpp::TAG tag) const {
     return find_by_tag(tag, document_node());
@@ -165,6 +207,13 @@ myhtmlpp::Tree::find_by_tag(myhtmlpp::TAG tag, const Node& scope_node) const {
     return res;
 }
 
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_by_tag(myhtmlpp::TAG tag,
+                            const CancellationToken& token) const {
+    return collect([&](const Node& node) { return node.tag_id() == tag; },
+                   token);
+}
+
 std::vector<myhtmlpp::Node>
 myhtmlpp::Tree::find_by_class(const std::string& cl) const {
     return find_by_class(cl, document_node());
@@ -186,6 +235,13 @@ myhtmlpp::Tree::find_by_class(const std::string& cl,
     return res;
 }
 
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_by_class(const std::string& cl,
+                              const CancellationToken& token) const {
+    return collect(
+        [&](const Node& node) { return node.at_view("class") == cl; }, token);
+}
+
 std::vector<myhtmlpp::Node>
 myhtmlpp::Tree::find_by_id(const std::string& id) const {
     return find_by_id(id, document_node());
@@ -207,6 +263,13 @@ myhtmlpp::Tree::find_by_id(const std::string& id,
     return res;
 }
 
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_by_id(const std::string& id,
+                           const CancellationToken& token) const {
+    return collect([&](const Node& node) { return node.at_view("id") == id; },
+                   token);
+}
+
 std::vector<myhtmlpp::Node>
 myhtmlpp::Tree::find_by_attr(const std::string& key,
                              const std::string& val) const {
@@ -229,6 +292,31 @@ myhtmlpp::Tree::find_by_attr(const std::string& key, const std::string& val,
     return res;
 }
 
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::find_by_attr(const std::string& key, const std::string& val,
+                             const CancellationToken& token) const {
+    return collect([&](const Node& node) { return node.at_view(key) == val; },
+                   token);
+}
+
+std::vector<myhtmlpp::Node>
+myhtmlpp::Tree::collect(const std::function<bool(const Node&)>& f,
+                        const CancellationToken& token) const {
+    std::vector<Node> res;
+    PeriodicCheck check(token);
+    walk_subtree(myhtml_tree_get_document(m_raw_tree),
+                 [&](myhtml_tree_node_t* node) {
+                     check();
+
+                     Node wrapped(node);
+                     if (f(wrapped)) {
+                         res.push_back(wrapped);
+                     }
+                 });
+
+    return res;
+}
+
 // Iterator
 myhtmlpp::Tree::Iterator::Iterator(Node node) : m_node(std::move(node)) {}
 
@@ -362,7 +450,7 @@ myhtmlpp::Tree::ConstIterator myhtmlpp::Tree::cend() const noexcept {
 }
 
 std::ostream& myhtmlpp::operator<<(std::ostream& os, const Tree& t) {
-    os << t.html();
+    t.write_html(ostream_sink(os));
 
     return os;
 }
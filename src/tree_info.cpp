@@ -0,0 +1,107 @@
+#include "tree_info.hpp"
+
+#include "utils.hpp"
+
+#include <cstdint>
+#include <myhtml/tree.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+void myhtmlpp::TreeInfo::build_order_index(myhtml_tree_t* tree) {
+    clear_order_index(tree);
+    ++m_generation;
+
+    // indices of the ancestors of the current node and the node itself
+    std::vector<uint32_t> stack;
+
+    walk_subtree(
+        myhtml_tree_get_document(tree),
+        [&](myhtml_tree_node_t* node) {
+            auto pre = static_cast<uint32_t>(m_order.size());
+
+            m_order.push_back(node);
+            m_nodes.push_back(
+                {pre, 0, pre + 1, static_cast<uint32_t>(stack.size())});
+            stack.push_back(pre);
+
+            return true;
+        },
+        [&](myhtml_tree_node_t* /*node*/) {
+            m_nodes[stack.back()].subtree_end =
+                static_cast<uint32_t>(m_order.size());
+            stack.pop_back();
+        });
+
+    // a node is finished after all nodes before it in pre-order that are
+    // not its ancestors and after all of its descendants.
+    for (auto& info : m_nodes) {
+        info.post = info.pre - info.depth + (info.subtree_end - info.pre) - 1;
+    }
+
+    // the vectors do not change any more, so the pointers stay valid
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        myhtml_node_set_data(m_order[i], &m_nodes[i]);
+    }
+
+    myhtml_callback_tree_node_insert_set(tree, on_tree_changed, this);
+    myhtml_callback_tree_node_remove_set(tree, on_tree_changed, this);
+}
+
+void myhtmlpp::TreeInfo::clear_order_index(myhtml_tree_t* tree) {
+    if (m_order.empty()) {
+        return;
+    }
+
+    myhtml_callback_tree_node_insert_set(tree, nullptr, nullptr);
+    myhtml_callback_tree_node_remove_set(tree, nullptr, nullptr);
+
+    // nodes that were inserted after the numbering have no data, nodes
+    // that were removed are cleared in on_tree_changed.
+    walk_subtree(myhtml_tree_get_document(tree), [](myhtml_tree_node_t* node) {
+        myhtml_node_set_data(node, nullptr);
+    });
+
+    m_nodes.clear();
+    m_order.clear();
+    ++m_generation;
+}
+
+bool myhtmlpp::TreeInfo::has_order_index() const { return !m_order.empty(); }
+
+const std::vector<myhtml_tree_node_t*>& myhtmlpp::TreeInfo::order() const {
+    return m_order;
+}
+
+uint64_t myhtmlpp::TreeInfo::generation() const { return m_generation; }
+
+std::string_view myhtmlpp::TreeInfo::retain_source(std::string_view source) {
+    m_source.assign(source.data(), source.size());
+
+    return m_source;
+}
+
+void myhtmlpp::TreeInfo::set_pooled_engine(bool pooled) {
+    m_pooled_engine = pooled;
+}
+
+bool myhtmlpp::TreeInfo::pooled_engine() const { return m_pooled_engine; }
+
+const myhtmlpp::NodeInfo*
+myhtmlpp::TreeInfo::lookup(myhtml_tree_node_t* node) {
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    return static_cast<const NodeInfo*>(myhtml_node_get_data(node));
+}
+
+void myhtmlpp::TreeInfo::on_tree_changed(myhtml_tree_t* tree,
+                                         myhtml_tree_node_t* node, void* ctx) {
+    // a removed node is no longer reachable from the document node
+    walk_subtree(node, [](myhtml_tree_node_t* removed) {
+        myhtml_node_set_data(removed, nullptr);
+    });
+
+    static_cast<TreeInfo*>(ctx)->clear_order_index(tree);
+}
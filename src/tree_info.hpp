@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <myhtml/tree.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myhtmlpp {
+
+/// Order numbers of a node, attached to the myhtml node through its
+/// user data pointer while the order index of its tree is valid.
+struct NodeInfo {
+    /// Position of the node in pre-order.
+    uint32_t pre;
+
+    /// Position of the node in post-order.
+    uint32_t post;
+
+    /// Pre-order position after the last descendant of the node.
+    uint32_t subtree_end;
+
+    /// Distance from the document node.
+    uint32_t depth;
+};
+
+/// Per-tree state kept next to the myhtml tree.
+class TreeInfo {
+public:
+    /**
+     * @brief Numbers all nodes of `tree` in one pass and attaches the
+     *        numbers to the nodes.
+     *
+     * Registers myhtml node insert and remove callbacks that invalidate the
+     * numbering when the tree is modified.
+     */
+    void build_order_index(myhtml_tree_t* tree);
+
+    /**
+     * @brief Detaches the numbers from the nodes of `tree` and releases
+     *        them.
+     */
+    void clear_order_index(myhtml_tree_t* tree);
+
+    /**
+     * @brief Returns whether the nodes are currently numbered.
+     */
+    [[nodiscard]] bool has_order_index() const;
+
+    /**
+     * @brief Returns the nodes in pre-order, empty without an order index.
+     */
+    [[nodiscard]] const std::vector<myhtml_tree_node_t*>& order() const;
+
+    /**
+     * @brief Returns a number that changes whenever the order index is
+     *        built or cleared, so holders of positions can tell that the
+     *        positions they stored are stale.
+     */
+    [[nodiscard]] uint64_t generation() const;
+
+    /**
+     * @brief Stores a copy of the source of the tree.
+     *
+     * @return A view of the copy, valid as long as the TreeInfo is alive.
+     */
+    std::string_view retain_source(std::string_view source);
+
+    /**
+     * @brief Marks the myhtml instance of the tree as borrowed from
+     *        EnginePool::shared, to return it there instead of destroying
+     *        it.
+     */
+    void set_pooled_engine(bool pooled);
+
+    /**
+     * @brief Returns whether the myhtml instance of the tree is borrowed
+     *        from EnginePool::shared.
+     */
+    [[nodiscard]] bool pooled_engine() const;
+
+    /**
+     * @brief Returns the numbers of `node`.
+     *
+     * @return A pointer to the numbers, nullptr if the tree of `node` has
+     *         no order index.
+     */
+    static const NodeInfo* lookup(myhtml_tree_node_t* node);
+
+private:
+    static void on_tree_changed(myhtml_tree_t* tree, myhtml_tree_node_t* node,
+                                void* ctx);
+
+    std::vector<NodeInfo> m_nodes;
+    std::vector<myhtml_tree_node_t*> m_order;
+    uint64_t m_generation = 0;
+
+    /// The source the tree was parsed from if it was retained.
+    std::string m_source;
+
+    bool m_pooled_engine = false;
+};
+
+}  // namespace myhtmlpp
@@ -1,6 +1,16 @@
 #pragma once
 
+#include "myhtmlpp/attribute.hpp"
+#include "myhtmlpp/cancellation.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <mycore/incoming.h>
+#include <myhtml/myhtml.h>
+#include <myhtml/tree.h>
 #include <optional>
+#include <string_view>
 
 template <typename Ret, typename Func, typename Arg>
 std::optional<Ret> optional_helper(Func f, Arg a) {
@@ -12,3 +22,149 @@ std::optional<Ret> optional_helper(Func f, Arg a) {
 
     return raw != nullptr ? std::make_optional(Ret(raw)) : std::nullopt;
 }
+
+// the source `tree` was parsed from, empty if it was not parsed from one
+// contiguous string (chunks of the same string are). token positions are
+// offsets into it.
+inline std::string_view source_of(myhtml_tree_t* tree) {
+    mycore_incoming_buffer_t* buffer = myhtml_tree_incoming_buffer_first(tree);
+    if (buffer == nullptr) {
+        return std::string_view();
+    }
+
+    const char* data = mycore_incoming_buffer_data(buffer);
+    size_t length = mycore_incoming_buffer_length(buffer);
+    for (buffer = mycore_incoming_buffer_next(buffer); buffer != nullptr;
+         buffer = mycore_incoming_buffer_next(buffer)) {
+        if (mycore_incoming_buffer_data(buffer) != data + length) {
+            return std::string_view();
+        }
+        length += mycore_incoming_buffer_length(buffer);
+    }
+
+    return std::string_view(data, length);
+}
+
+// calls f for `root` and all of its descendants in document order
+// without recursion and without allocating.
+template <typename Func>
+void walk_subtree(myhtml_tree_node_t* root, Func f) {
+    myhtml_tree_node_t* node = root;
+
+    while (node != nullptr) {
+        f(node);
+
+        if (myhtml_tree_node_t* child = myhtml_node_child(node)) {
+            node = child;
+            continue;
+        }
+
+        while (node != root && myhtml_node_next(node) == nullptr) {
+            node = myhtml_node_parent(node);
+        }
+
+        node = node != root ? myhtml_node_next(node) : nullptr;
+    }
+}
+
+// returns the first node of the subtree of `root` in document order for
+// which `f` returns true, nullptr if there is none. stops at the match.
+template <typename Func>
+myhtml_tree_node_t* find_in_subtree(myhtml_tree_node_t* root, Func f) {
+    myhtml_tree_node_t* node = root;
+
+    while (node != nullptr) {
+        if (f(node)) {
+            return node;
+        }
+
+        if (myhtml_tree_node_t* child = myhtml_node_child(node)) {
+            node = child;
+            continue;
+        }
+
+        while (node != root && myhtml_node_next(node) == nullptr) {
+            node = myhtml_node_parent(node);
+        }
+
+        node = node != root ? myhtml_node_next(node) : nullptr;
+    }
+
+    return nullptr;
+}
+
+// like walk_subtree, but `enter` returns whether the descendants of a node
+// are visited and `leave` is called after the descendants of every node
+// that was entered.
+template <typename Enter, typename Leave>
+void walk_subtree(myhtml_tree_node_t* root, Enter enter, Leave leave) {
+    myhtml_tree_node_t* node = root;
+
+    while (node != nullptr) {
+        bool descend = enter(node);
+
+        myhtml_tree_node_t* child =
+            descend ? myhtml_node_child(node) : nullptr;
+        if (child != nullptr) {
+            node = child;
+            continue;
+        }
+
+        if (descend) {
+            leave(node);
+        }
+
+        while (node != root && myhtml_node_next(node) == nullptr) {
+            node = myhtml_node_parent(node);
+            leave(node);
+        }
+
+        node = node != root ? myhtml_node_next(node) : nullptr;
+    }
+}
+
+namespace myhtmlpp {
+
+// access to the myhtml pointers wrapped by the public classes.
+struct RawAccess {
+    static myhtml_tree_node_t* node(const Node& node) {
+        return node.m_raw_node;
+    }
+
+    static myhtml_tree_attr_t* attribute(const Attribute& attr) {
+        return attr.m_raw_attribute;
+    }
+
+    static myhtml_tree_t* tree(const Tree& tree) { return tree.m_raw_tree; }
+
+    static TreeInfo* info(const Tree& tree) { return tree.m_info.get(); }
+
+    static const SelectorData* selector(const Selector& selector) {
+        return selector.m_data.get();
+    }
+};
+
+// checks a CancellationToken on every `interval`-th call, reading the clock
+// for every node would cost more than matching most of them.
+class PeriodicCheck {
+public:
+    explicit PeriodicCheck(const CancellationToken& token,
+                           unsigned int interval = 256)
+        : m_token(token), m_interval(interval) {
+        token.check();
+    }
+
+    void operator()() {
+        if (++m_count == m_interval) {
+            m_count = 0;
+            m_token.check();
+        }
+    }
+
+private:
+    const CancellationToken& m_token;
+    unsigned int m_interval;
+    unsigned int m_count = 0;
+};
+
+}  // namespace myhtmlpp
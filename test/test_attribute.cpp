@@ -9,6 +9,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 
 TEST_CASE("attribute") {
@@ -67,6 +68,20 @@ TEST_CASE("attribute") {
         CHECK(hidden_attr.value().empty());
     }
 
+    SUBCASE("views") {
+        CHECK(class_attr.key_view() == "class");
+        CHECK(class_attr.value_view() == "hello");
+
+        CHECK(src_attr.key_view() == "src");
+        CHECK(src_attr.value_view() == "image.jpg");
+
+        CHECK(hidden_attr.key_view() == "hidden");
+        CHECK(hidden_attr.value_view().empty());
+
+        CHECK(bad_attr.key_view().empty());
+        CHECK(bad_attr.value_view().empty());
+    }
+
     SUBCASE("traversal") {
         CHECK(!class_attr.previous().has_value());
         CHECK(!class_attr.next().has_value());
@@ -0,0 +1,95 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/cancellation.hpp"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/static_selector.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+using namespace myhtmlpp::literals;
+
+TEST_CASE("cancellation") {
+    std::string html("<html><body>");
+    for (size_t i = 0; i < 1000; ++i) {
+        html += "<ul class=\"list\"><li id=\"item\" lang=\"en\">one</li>"
+                "<li>two</li></ul>";
+    }
+    html += "</body></html>";
+
+    SUBCASE("token") {
+        myhtmlpp::CancellationToken token;
+        CHECK_FALSE(token.cancelled());
+        CHECK_FALSE(token.deadline().has_value());
+        CHECK_NOTHROW(token.check());
+
+        auto copy = token;
+        copy.cancel();
+        CHECK(token.cancelled());
+        CHECK_THROWS_AS(token.check(), myhtmlpp::cancelled_error);
+
+        auto expired = myhtmlpp::CancellationToken::after(
+            std::chrono::milliseconds(-1));
+        CHECK(expired.deadline().has_value());
+        CHECK(expired.cancelled());
+
+        auto later =
+            myhtmlpp::CancellationToken::after(std::chrono::hours(1));
+        CHECK_FALSE(later.cancelled());
+    }
+
+    SUBCASE("parse") {
+        myhtmlpp::ParseOptions options;
+        options.cancellation = myhtmlpp::CancellationToken();
+        auto tree = myhtmlpp::parse(html, options);
+        CHECK(tree.find_by_tag(myhtmlpp::TAG::LI).size() == 2000);
+
+        options.cancellation->cancel();
+        CHECK_THROWS_AS(static_cast<void>(myhtmlpp::parse(html, options)),
+                        myhtmlpp::cancelled_error);
+        CHECK_THROWS_AS(
+            static_cast<void>(myhtmlpp::parse_fragment(html, options)),
+            myhtmlpp::cancelled_error);
+    }
+
+    SUBCASE("queries") {
+        auto tree = myhtmlpp::parse(html);
+        myhtmlpp::CancellationToken token;
+
+        CHECK(tree.find_by_tag(myhtmlpp::TAG::LI, token) ==
+              tree.find_by_tag(myhtmlpp::TAG::LI));
+        CHECK(tree.find_by_tag("li", token) == tree.find_by_tag("li"));
+        CHECK(tree.find_by_class("list", token) == tree.find_by_class("list"));
+        CHECK(tree.find_by_id("item", token) == tree.find_by_id("item"));
+        CHECK(tree.find_by_attr("lang", "en", token) ==
+              tree.find_by_attr("lang", "en"));
+
+        auto is_text = [](const myhtmlpp::Node& node) {
+            return node.tag_id() == myhtmlpp::TAG::TEXT_;
+        };
+        CHECK(tree.filter(is_text, token) == tree.filter(is_text).to_vector());
+
+        CHECK(tree.select("ul > li#item", token) ==
+              tree.select("ul > li#item"));
+        CHECK(tree.select("li:first-child", token).size() == 1000);
+        CHECK(tree.select("ul.list li"_sel, token).size() == 2000);
+
+        token.cancel();
+        CHECK_THROWS_AS(
+            static_cast<void>(tree.find_by_tag(myhtmlpp::TAG::LI, token)),
+            myhtmlpp::cancelled_error);
+        CHECK_THROWS_AS(static_cast<void>(tree.filter(is_text, token)),
+                        myhtmlpp::cancelled_error);
+        CHECK_THROWS_AS(static_cast<void>(tree.select("ul li", token)),
+                        myhtmlpp::cancelled_error);
+        CHECK_THROWS_AS(static_cast<void>(tree.select("li:first-child", token)),
+                        myhtmlpp::cancelled_error);
+        CHECK_THROWS_AS(static_cast<void>(tree.select("ul li"_sel, token)),
+                        myhtmlpp::cancelled_error);
+    }
+}
@@ -11,6 +11,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -106,6 +107,11 @@ TEST_CASE("node") {
         CHECK(!p_node.is_void_element());
         CHECK(p_node.html() == R"(<p class="hello">)");
 
+        CHECK(p_text_node.text_view() == "Hello World");
+        CHECK(p_text_node.tag_name_view() == "-text");
+        CHECK(p_node.tag_name_view() == "p");
+        CHECK(p_node.text_view().empty());
+
         auto img_node_it =
             std::find_if(tree.begin(), tree.end(), [](const auto& node) {
                 return node.tag_id() == myhtmlpp::TAG::IMG;
@@ -127,6 +133,26 @@ TEST_CASE("node") {
 
         auto div_node = tree2.find_by_tag("div").front();
         CHECK(div_node.inner_text() == "some   text bold");
+        CHECK(div_node.inner_text_length() == 16);
+
+        std::string buffer = "> ";
+        div_node.inner_text_into(buffer);
+        CHECK(buffer == "> some   text bold");
+
+        std::string copied;
+        div_node.inner_text_copy(std::back_inserter(copied));
+        CHECK(copied == "some   text bold");
+
+        CHECK(bad_node.inner_text().empty());
+
+        // deeply nested documents are walked without recursion
+        std::string deep;
+        for (size_t i = 0; i < 10000; ++i) {
+            deep += "<span>";
+        }
+        deep += "x";
+        auto tree3 = myhtmlpp::parse(deep);
+        CHECK(tree3.document_node().inner_text() == "x");
     }
 
     SUBCASE("node traversal") {
@@ -158,6 +184,67 @@ TEST_CASE("node") {
         }
     }
 
+    SUBCASE("document order") {
+        auto li_nodes = tree.find_by_tag(myhtmlpp::TAG::LI);
+        REQUIRE(li_nodes.size() == 2);
+        auto p_node = tree.find_by_tag(myhtmlpp::TAG::P).front();
+
+        auto check_order = [&] {
+            CHECK(doc.is_ancestor_of(li_nodes[0]));
+            CHECK(body_node.is_ancestor_of(li_nodes[1]));
+            CHECK(!li_nodes[0].is_ancestor_of(li_nodes[1]));
+            CHECK(!head_node.is_ancestor_of(li_nodes[0]));
+            CHECK(!body_node.is_ancestor_of(body_node));
+            CHECK(!li_nodes[0].is_ancestor_of(bad_node));
+
+            CHECK(body_node.document_position(body_node) ==
+                  myhtmlpp::DOCUMENT_POSITION::EQUAL);
+            CHECK(body_node.document_position(li_nodes[0]) ==
+                  myhtmlpp::DOCUMENT_POSITION::CONTAINED_BY);
+            CHECK(li_nodes[0].document_position(html_node) ==
+                  myhtmlpp::DOCUMENT_POSITION::CONTAINS);
+            CHECK(li_nodes[0].document_position(li_nodes[1]) ==
+                  myhtmlpp::DOCUMENT_POSITION::FOLLOWING);
+            CHECK(li_nodes[1].document_position(p_node) ==
+                  myhtmlpp::DOCUMENT_POSITION::PRECEDING);
+            CHECK(head_node.document_position(li_nodes[1]) ==
+                  myhtmlpp::DOCUMENT_POSITION::FOLLOWING);
+            CHECK(head_node.document_position(bad_node) ==
+                  myhtmlpp::DOCUMENT_POSITION::DISCONNECTED);
+
+            CHECK(doc.subtree_size() == static_cast<size_t>(std::distance(
+                                            tree.begin(), tree.end())));
+            CHECK(li_nodes[0].subtree_size() == 2);
+
+            std::vector<myhtmlpp::Node> shuffled{li_nodes[1], body_node,
+                                                 p_node, head_node,
+                                                 li_nodes[0], doc};
+            std::sort(shuffled.begin(), shuffled.end(),
+                      myhtmlpp::DocumentOrder());
+            CHECK(shuffled ==
+                  std::vector<myhtmlpp::Node>{doc, head_node, body_node, p_node,
+                                              li_nodes[0], li_nodes[1]});
+        };
+
+        CHECK(!tree.has_order_index());
+        CHECK(!doc.pre_order_index().has_value());
+        check_order();
+
+        tree.build_order_index();
+        CHECK(tree.has_order_index());
+        CHECK(doc.pre_order_index() == 0);
+        CHECK(doc.post_order_index() == doc.subtree_size() - 1);
+        CHECK(html_node.pre_order_index() == 2);
+        CHECK(li_nodes[0].post_order_index() <
+              li_nodes[1].post_order_index());
+        check_order();
+
+        tree.clear_order_index();
+        CHECK(!tree.has_order_index());
+        CHECK(!li_nodes[0].pre_order_index().has_value());
+        check_order();
+    }
+
     SUBCASE("html string") {
         CHECK(head_node.html() == "<head>");
         CHECK(head_node.html_deep() == R"(<head>
@@ -174,6 +261,49 @@ TEST_CASE("node") {
         CHECK(img_node.html() == R"(<img src="image.jpg" hidden="">)");
     }
 
+    SUBCASE("source") {
+        CHECK(tree.source() == html);
+        CHECK(doc.raw_html() == html);
+        CHECK(head_node.raw_html() == R"(<head>
+    <title>Foo</title>
+</head>)");
+
+        auto p_node = tree.find_by_tag(myhtmlpp::TAG::P).front();
+        auto range = p_node.source_range();
+        REQUIRE(range.has_value());
+        CHECK(range->begin == html.find("<p"));
+        CHECK(range->size() == p_node.raw_html().size());
+        CHECK(p_node.raw_html() == R"(<p class="hello">Hello World</p>)");
+        CHECK(p_node.first_child()->raw_html() == "Hello World");
+
+        auto ul_node = tree.find_by_tag(myhtmlpp::TAG::UL).front();
+        CHECK(ul_node.raw_html() == R"(<ul>
+        <li>one</li>
+        <li>two</li>
+    </ul>)");
+
+        auto img_node = tree.find_by_tag(myhtmlpp::TAG::IMG).front();
+        CHECK(img_node.raw_html() == R"(<img src="image.jpg" hidden>)");
+
+        CHECK_FALSE(bad_node.source_range().has_value());
+        CHECK(bad_node.raw_html().empty());
+
+        std::string implied_html("<p>a<P>b</P ><!-- c -->");
+        auto implied_tree = myhtmlpp::parse(implied_html);
+        auto paragraphs = implied_tree.find_by_tag(myhtmlpp::TAG::P);
+        REQUIRE(paragraphs.size() == 2);
+        CHECK(paragraphs.at(0).raw_html() == "<p>a");
+        CHECK(paragraphs.at(1).raw_html() == "<P>b</P >");
+        CHECK(implied_tree.body_node().raw_html() == implied_html);
+        CHECK_FALSE(implied_tree.head_node().source_range().has_value());
+
+        // the implied <html> starts in the body, after the empty <head>
+        std::string body_only("<p>x</p>");
+        auto body_only_tree = myhtmlpp::parse(body_only);
+        CHECK(body_only_tree.html_node().raw_html() == body_only);
+        CHECK(body_only_tree.body_node().raw_html() == body_only);
+    }
+
     SUBCASE("attributes") {
         CHECK(!doc.has_attributes());
         CHECK(!html_node.has_attributes());
@@ -193,6 +323,10 @@ TEST_CASE("node") {
         CHECK(div_node.at("class").value() == "class");
         CHECK(!div_node.at("style").has_value());
         CHECK(!div_node.has_attribute("style"));
+        CHECK(div_node.value_view("class") == "class");
+        CHECK(div_node.value_view("style").empty());
+        CHECK(div_node.at_view("id").value() == "bla");
+        CHECK(!div_node.at_view("style").has_value());
         auto class_attr = div_node.last_attribute().value();
         auto [k, v] = class_attr;
         CHECK(class_attr.key() == "class");
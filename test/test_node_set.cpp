@@ -0,0 +1,131 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/node_set.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <myhtml/myhtml.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("node set") {
+    std::string html(
+        R"(<!DOCTYPE html>
+<html>
+<body>
+    <nav><a href="/">home</a><a href="/about">about</a></nav>
+    <main>
+        <a href="/one">one</a>
+        <p><a href="/two">two</a></p>
+    </main>
+    <footer><a href="/">home</a></footer>
+</body>
+</html>)");
+
+    auto tree = myhtmlpp::parse(html);
+
+    CHECK_THROWS_AS(myhtmlpp::NodeSet{tree}, std::logic_error);
+
+    tree.build_order_index();
+
+    auto links = tree.select("a");
+    auto nav_links = tree.select("nav a");
+    auto main_links = tree.select("main a");
+    REQUIRE(links.size() == 5);
+
+    myhtmlpp::NodeSet all(tree, links);
+    myhtmlpp::NodeSet nav(tree, nav_links);
+    myhtmlpp::NodeSet main(tree, main_links);
+
+    SUBCASE("insert and erase") {
+        myhtmlpp::NodeSet set(tree);
+        CHECK(set.empty());
+        CHECK(set.size() == 0);
+
+        CHECK(set.insert(links[2]));
+        CHECK(!set.insert(links[2]));
+        CHECK(set.insert(tree.document_node()));
+        CHECK(set.contains(links[2]));
+        CHECK(!set.contains(links[1]));
+        CHECK(set.size() == 2);
+
+        CHECK(set.erase(links[2]));
+        CHECK(!set.erase(links[2]));
+        CHECK(set.size() == 1);
+
+        set.clear();
+        CHECK(set.empty());
+
+        CHECK(!set.contains(myhtmlpp::Node(nullptr)));
+        CHECK_THROWS_AS(set.insert(myhtmlpp::Node(nullptr)),
+                        std::invalid_argument);
+    }
+
+    SUBCASE("set algebra") {
+        CHECK((all - nav).to_vector() == std::vector<myhtmlpp::Node>{
+                                             links[2], links[3], links[4]});
+        CHECK((all - nav - main).to_vector() ==
+              std::vector<myhtmlpp::Node>{links[4]});
+        CHECK((nav | main).size() == 4);
+        CHECK((all & main) == main);
+        CHECK((nav & main).empty());
+
+        auto set = nav;
+        set |= main;
+        set -= nav;
+        CHECK(set == main);
+        set &= nav;
+        CHECK(set.empty());
+        CHECK(set != main);
+
+        auto other_tree = myhtmlpp::parse(html);
+        other_tree.build_order_index();
+        myhtmlpp::NodeSet other(other_tree);
+        CHECK_THROWS_AS(all |= other, std::invalid_argument);
+        CHECK(!other.contains(links[0]));
+    }
+
+    SUBCASE("document order") {
+        std::vector<myhtmlpp::Node> reversed(links.rbegin(), links.rend());
+        myhtmlpp::NodeSet set(tree, reversed);
+
+        CHECK(set.to_vector() == links);
+        CHECK(std::vector<myhtmlpp::Node>(set.begin(), set.end()) == links);
+        CHECK(std::distance(set.cbegin(), set.cend()) == 5);
+
+        myhtmlpp::NodeSet empty(tree);
+        CHECK(empty.begin() == empty.end());
+    }
+
+    SUBCASE("rebuilt index") {
+        myhtmlpp::NodeSet set(tree, nav_links);
+
+        // add a link to <main>, which drops the order index
+        myhtml_tree_node_t* link = myhtml_node_create(
+            myhtmlpp::RawAccess::tree(tree),
+            static_cast<myhtml_tag_id_t>(myhtmlpp::TAG::A),
+            static_cast<myhtml_namespace_t>(myhtmlpp::NAMESPACE::HTML));
+        myhtml_node_append_child(
+            myhtmlpp::RawAccess::node(tree.select("main").front()), link);
+        CHECK(!tree.has_order_index());
+        CHECK_THROWS_AS(static_cast<void>(set.contains(links[0])),
+                        std::logic_error);
+
+        // the new index numbers one more node than the bits of the set
+        tree.build_order_index();
+        CHECK_THROWS_AS(set.insert(myhtmlpp::Node(link)), std::logic_error);
+        CHECK_THROWS_AS(set.erase(links[0]), std::logic_error);
+        CHECK_THROWS_AS(static_cast<void>(set.to_vector()), std::logic_error);
+        CHECK_THROWS_AS(static_cast<void>(set.begin()), std::logic_error);
+        CHECK_THROWS_AS(all |= set, std::logic_error);
+
+        myhtmlpp::NodeSet rebuilt(tree, tree.select("a"));
+        CHECK(rebuilt.size() == 6);
+        CHECK(rebuilt.contains(myhtmlpp::Node(link)));
+    }
+}
@@ -0,0 +1,114 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <string>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+
+namespace {
+
+// a coroutine that starts right away and reports its end through a future
+struct Task {
+    struct promise_type {
+        std::promise<void> done;
+
+        Task get_return_object() { return Task{done.get_future()}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { done.set_value(); }
+        void unhandled_exception() {
+            done.set_exception(std::current_exception());
+        }
+    };
+
+    std::future<void> finished;
+};
+
+Task count_items(std::string html, myhtmlpp::ParseOptions options,
+                 myhtmlpp::Executor executor, size_t& items) {
+    myhtmlpp::Tree tree = co_await myhtmlpp::parse_awaitable(
+        std::move(html), std::move(options), std::move(executor));
+    items = tree.find_by_tag(myhtmlpp::TAG::LI).size();
+}
+
+Task catch_limit(std::string html, myhtmlpp::ParseOptions options,
+                 myhtmlpp::Executor executor, bool& caught) {
+    try {
+        auto tree = co_await myhtmlpp::parse_awaitable(
+            std::move(html), std::move(options), std::move(executor));
+    } catch (const myhtmlpp::limit_exceeded& e) {
+        caught = e.limit() == myhtmlpp::LIMIT::DEPTH;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("parse awaitable") {
+    std::string html("<ul><li>one</li><li>two</li><li>three</li></ul>");
+
+    std::string nested;
+    for (size_t i = 0; i < 100; ++i) {
+        nested += "<div>";
+    }
+    myhtmlpp::ParseOptions limited;
+    limited.limits.depth = 50;
+
+    size_t jobs = 0;
+    myhtmlpp::Executor inline_executor = [&](std::function<void()> job) {
+        ++jobs;
+        job();
+    };
+
+    SUBCASE("shared executor") {
+        size_t items = 0;
+        auto task = count_items(html, {}, myhtmlpp::shared_executor(), items);
+        task.finished.get();
+        CHECK(items == 3);
+
+        bool caught = false;
+        catch_limit(nested, limited, myhtmlpp::shared_executor(), caught)
+            .finished.get();
+        CHECK(caught);
+
+        auto failing =
+            count_items(nested, limited, myhtmlpp::shared_executor(), items);
+        CHECK_THROWS_AS(failing.finished.get(), myhtmlpp::limit_exceeded);
+    }
+
+    SUBCASE("inline executor") {
+        // the coroutine is resumed and finishes inside await_suspend
+        size_t items = 0;
+        auto task = count_items(html, {}, inline_executor, items);
+        CHECK(jobs == 1);
+        CHECK(task.finished.wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready);
+        task.finished.get();
+        CHECK(items == 3);
+
+        bool caught = false;
+        catch_limit(nested, limited, inline_executor, caught).finished.get();
+        CHECK(jobs == 2);
+        CHECK(caught);
+
+        auto failing = count_items(nested, limited, inline_executor, items);
+        CHECK_THROWS_AS(failing.finished.get(), myhtmlpp::limit_exceeded);
+    }
+}
+
+#else
+
+TEST_CASE("parse awaitable") {
+    MESSAGE("the compiler does not support coroutines");
+}
+
+#endif
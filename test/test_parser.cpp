@@ -1,8 +1,18 @@
 #include "doctest/doctest.h"
 #include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
 #include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/tree.hpp"
 
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 
 TEST_CASE("parser") {
     std::string html(
@@ -42,4 +52,272 @@ TEST_CASE("parser") {
     REQUIRE_NOTHROW(myhtmlpp::parse_fragment(
         html, myhtmlpp::TAG::A, myhtmlpp::NAMESPACE::HTML,
         myhtmlpp::OPTION::PARSE_MODE_SEPARATELY, 2, 0));
+    myhtmlpp::ParseOptions options;
+    options.keep_source = true;
+    auto tree = myhtmlpp::parse(std::string(html), options);
+    CHECK(tree.source() == html);
+    CHECK(tree.find_by_tag(myhtmlpp::TAG::LI).front().raw_html() ==
+          "<li>one</li>");
+
+    auto fragment = myhtmlpp::parse_fragment("<b>x</b>", options);
+    CHECK(fragment.source() == "<b>x</b>");
+
+    std::string page(
+        "<html><head><!-- a --><style>p { color: red; }</style>"
+        "<script src=\"a.js\"></script><script>var x = '<p>';</script>"
+        "</head><body><p>one<!-- b -->two</p><script>f();</script>"
+        "</body></html>");
+
+    auto full = myhtmlpp::parse(page);
+    CHECK(full.find_by_tag(myhtmlpp::TAG::COMMENT_).size() == 2);
+    CHECK(full.find_by_tag(myhtmlpp::TAG::TEXT_).size() == 5);
+
+    myhtmlpp::ParseOptions drop;
+    drop.drop_comments = true;
+    auto without_comments = myhtmlpp::parse(page, drop);
+    CHECK(without_comments.find_by_tag(myhtmlpp::TAG::COMMENT_).empty());
+    CHECK(without_comments.find_by_tag(myhtmlpp::TAG::P).front().inner_text() ==
+          "onetwo");
+
+    drop.drop_script_text = true;
+    drop.drop_style_text = true;
+    auto pruned = myhtmlpp::parse(page, drop);
+    CHECK(pruned.find_by_tag(myhtmlpp::TAG::COMMENT_).empty());
+    CHECK(pruned.find_by_tag(myhtmlpp::TAG::SCRIPT).size() == 3);
+    CHECK(pruned.find_by_tag(myhtmlpp::TAG::STYLE).size() == 1);
+    CHECK(pruned.find_by_tag(myhtmlpp::TAG::SCRIPT).front().at("src") ==
+          "a.js");
+    for (const auto& node : pruned.find_by_tag(myhtmlpp::TAG::TEXT_)) {
+        auto parent = node.parent().value().tag_id();
+        CHECK(parent != myhtmlpp::TAG::SCRIPT);
+        CHECK(parent != myhtmlpp::TAG::STYLE);
+    }
+    CHECK(pruned.body_node().inner_text() == "onetwo");
+
+    myhtmlpp::ParseOptions compact;
+    compact.drop_whitespace_text = true;
+    auto compact_tree = myhtmlpp::parse(html, compact);
+    CHECK(compact_tree.find_by_tag(myhtmlpp::TAG::TEXT_).size() == 5);
+    auto ul = compact_tree.find_by_tag(myhtmlpp::TAG::UL).front();
+    CHECK(ul.children().size() == 3);
+
+    auto preformatted = myhtmlpp::parse(
+        "<pre>\n  x\n</pre><pre> </pre><textarea>  </textarea>"
+        "<p> <b> </b> </p>",
+        compact);
+    auto texts = preformatted.find_by_tag(myhtmlpp::TAG::TEXT_);
+    REQUIRE(texts.size() == 3);
+    CHECK(texts[1].text() == " ");
+    CHECK(texts[2].text() == "  ");
+    auto b = preformatted.find_by_tag(myhtmlpp::TAG::B).front();
+    CHECK(b.children().empty());
+
+    std::string long_page =
+        "<html><head><title>T</title><meta charset=\"utf-8\">"
+        "<link rel=\"canonical\" href=\"/c\"></head>"
+        "<body class=\"main\">";
+    for (size_t i = 0; i < 2000; ++i) {
+        long_page += "<div><p>paragraph</p></div>";
+    }
+    long_page += "</body></html>";
+    auto full_page = myhtmlpp::parse(long_page);
+    size_t full_size = full_page.find_by_tag(myhtmlpp::TAG::P).size();
+    CHECK(full_size == 2000);
+
+    myhtmlpp::ParseOptions early;
+    early.chunk_size = 64;
+    early.stop = myhtmlpp::STOP::AFTER_HEAD;
+    auto head_only = myhtmlpp::parse(long_page, early);
+    CHECK(head_only.find_by_tag(myhtmlpp::TAG::TITLE).size() == 1);
+    CHECK(head_only.find_by_tag(myhtmlpp::TAG::LINK).front().at("href") ==
+          "/c");
+    CHECK(head_only.find_by_tag(myhtmlpp::TAG::P).size() < 10);
+    CHECK(head_only.body_node().good());
+
+    early.stop = myhtmlpp::STOP::AFTER_BODY_START;
+    early.keep_source = true;
+    auto body_start = myhtmlpp::parse(long_page, early);
+    CHECK(body_start.body_node().at("class") == "main");
+    CHECK(body_start.find_by_tag(myhtmlpp::TAG::P).size() < 10);
+    CHECK(body_start.source().size() < long_page.size());
+    CHECK(long_page.compare(0, body_start.source().size(),
+                            body_start.source()) == 0);
+
+    myhtmlpp::ParseOptions bytes;
+    bytes.stop_after_bytes = 1000;
+    bytes.chunk_size = 100;
+    auto prefix = myhtmlpp::parse(long_page, bytes);
+    CHECK(prefix.find_by_tag(myhtmlpp::TAG::P).size() < 40);
+    CHECK(prefix.find_by_tag(myhtmlpp::TAG::TITLE).size() == 1);
+
+    myhtmlpp::ParseOptions predicate;
+    predicate.chunk_size = 1;
+    size_t paragraphs = 0;
+    predicate.stop_when = [&](const myhtmlpp::Node& node) {
+        return node.tag_id() == myhtmlpp::TAG::P && ++paragraphs == 3;
+    };
+    auto three = myhtmlpp::parse(long_page, predicate);
+    CHECK(three.find_by_tag(myhtmlpp::TAG::P).size() == 3);
+
+    myhtmlpp::ParseOptions throwing;
+    throwing.stop_when = [](const myhtmlpp::Node& node) -> bool {
+        if (node.tag_id() == myhtmlpp::TAG::P) {
+            throw std::runtime_error("p");
+        }
+        return false;
+    };
+    CHECK_THROWS_AS(static_cast<void>(myhtmlpp::parse(long_page, throwing)),
+                    std::runtime_error);
+    CHECK_THROWS_AS(
+        static_cast<void>(myhtmlpp::try_parse(long_page, throwing)),
+        std::runtime_error);
+
+    auto fragment_prefix = myhtmlpp::parse_fragment(long_page, bytes);
+    CHECK(fragment_prefix.find_by_tag(myhtmlpp::TAG::P).size() < 40);
+    CHECK_FALSE(fragment_prefix.find_by_tag(myhtmlpp::TAG::P).empty());
+
+    // "Привет" in windows-1251
+    std::string cyrillic(
+        "<meta charset=\"windows-1251\"><p>\xcf\xf0\xe8\xe2\xe5\xf2</p>");
+    CHECK(myhtmlpp::detect_encoding(cyrillic) ==
+          myhtmlpp::ENCODING::WINDOWS_1251);
+
+    myhtmlpp::ParseOptions detect;
+    detect.encoding = myhtmlpp::ENCODING::AUTO;
+    auto decoded = myhtmlpp::parse(cyrillic, detect);
+    CHECK(decoded.encoding() == myhtmlpp::ENCODING::WINDOWS_1251);
+    CHECK(decoded.find_by_tag(myhtmlpp::TAG::P).front().inner_text() ==
+          "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82");
+
+    myhtmlpp::ParseOptions explicit_encoding;
+    explicit_encoding.encoding = myhtmlpp::ENCODING::WINDOWS_1251;
+    auto cp1251 = myhtmlpp::parse("<p>\xcf\xf0\xe8\xe2\xe5\xf2</p>",
+                                  explicit_encoding);
+    CHECK(cp1251.find_by_tag(myhtmlpp::TAG::P).front().inner_text() ==
+          "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82");
+
+    CHECK(myhtmlpp::detect_encoding("<p>no charset</p>") == std::nullopt);
+    CHECK(myhtmlpp::detect_encoding("<meta charset=utf-16><p>x</p>") ==
+          myhtmlpp::ENCODING::UTF_8);
+    detect.fallback_encoding = myhtmlpp::ENCODING::WINDOWS_1252;
+    CHECK(myhtmlpp::parse("<p>x</p>", detect).encoding() ==
+          myhtmlpp::ENCODING::WINDOWS_1252);
+
+    // a byte order mark overrides the options and is not parsed
+    std::string utf8_bom("\xef\xbb\xbf<p>x</p>");
+    CHECK(myhtmlpp::detect_encoding(utf8_bom) == myhtmlpp::ENCODING::UTF_8);
+    auto bom_tree = myhtmlpp::parse(utf8_bom, explicit_encoding);
+    CHECK(bom_tree.encoding() == myhtmlpp::ENCODING::UTF_8);
+    CHECK(bom_tree.body_node().inner_text() == "x");
+
+    const char utf16[] = "\xff\xfe<\0p\0>\0x\0<\0/\0p\0>\0";
+    std::string utf16_bom(utf16, sizeof(utf16) - 1);
+    CHECK(myhtmlpp::detect_encoding(utf16_bom) ==
+          myhtmlpp::ENCODING::UTF_16LE);
+    auto utf16_tree = myhtmlpp::parse(utf16_bom);
+    CHECK(utf16_tree.encoding() == myhtmlpp::ENCODING::UTF_16LE);
+    CHECK(utf16_tree.find_by_tag(myhtmlpp::TAG::P).front().inner_text() ==
+          "x");
+
+    std::string nested;
+    for (size_t i = 0; i < 100; ++i) {
+        nested += "<div>";
+    }
+
+    myhtmlpp::ParseOptions limited;
+    limited.limits.depth = 50;
+    CHECK_THROWS_AS(static_cast<void>(myhtmlpp::parse(nested, limited)),
+                    myhtmlpp::limit_exceeded);
+    try {
+        static_cast<void>(myhtmlpp::parse(nested, limited));
+    } catch (const myhtmlpp::limit_exceeded& e) {
+        CHECK(e.limit() == myhtmlpp::LIMIT::DEPTH);
+        CHECK(e.status_code() == myhtmlpp::limit_exceeded_status);
+    }
+    limited.limits.depth = 200;
+    CHECK(myhtmlpp::parse(nested, limited).find_by_tag("div").size() == 100);
+
+    myhtmlpp::ParseOptions attribute_limit;
+    attribute_limit.limits.attributes = 3;
+    CHECK_NOTHROW(myhtmlpp::parse("<p a b c>x</p>", attribute_limit));
+    CHECK_THROWS_AS(
+        static_cast<void>(myhtmlpp::parse("<p a b c d>x</p>", attribute_limit)),
+        myhtmlpp::limit_exceeded);
+
+    myhtmlpp::ParseOptions memory_limit;
+    memory_limit.limits.tree_memory = 10000;
+    CHECK_THROWS_AS(static_cast<void>(myhtmlpp::parse(long_page, memory_limit)),
+                    myhtmlpp::limit_exceeded);
+
+    myhtmlpp::ParseOptions node_limit;
+    node_limit.limits.nodes = 100;
+    node_limit.limits.truncate = true;
+    node_limit.chunk_size = 64;
+    auto truncated = myhtmlpp::parse(long_page, node_limit);
+    CHECK_FALSE(truncated.find_by_tag(myhtmlpp::TAG::P).empty());
+    CHECK(truncated.find_by_tag(myhtmlpp::TAG::P).size() < 100);
+
+    myhtmlpp::ParseOptions size_limit;
+    size_limit.limits.input_size = 1000;
+    CHECK_THROWS_AS(static_cast<void>(myhtmlpp::parse(long_page, size_limit)),
+                    myhtmlpp::limit_exceeded);
+    size_limit.limits.truncate = true;
+    size_limit.keep_source = true;
+    auto head_part = myhtmlpp::parse(long_page, size_limit);
+    CHECK(head_part.source().size() <= 1000);
+    CHECK(head_part.find_by_tag(myhtmlpp::TAG::TITLE).size() == 1);
+
+    auto parsed = myhtmlpp::try_parse(html);
+    REQUIRE(parsed.has_value());
+    CHECK(parsed->find_by_tag(myhtmlpp::TAG::LI).size() == 3);
+
+    auto parsed_fragment = myhtmlpp::try_parse_fragment("<li>a</li>", {},
+                                                        myhtmlpp::TAG::UL);
+    REQUIRE(parsed_fragment);
+    CHECK(parsed_fragment.value().find_by_tag(myhtmlpp::TAG::LI).size() == 1);
+
+    limited.limits.depth = 50;
+    auto too_deep = myhtmlpp::try_parse(nested, limited);
+    REQUIRE_FALSE(too_deep);
+    CHECK(too_deep.error() == myhtmlpp::limit_exceeded_status);
+
+    myhtmlpp::ParseOptions cancelled;
+    cancelled.cancellation = myhtmlpp::CancellationToken();
+    cancelled.cancellation->cancel();
+    auto not_parsed = myhtmlpp::try_parse(html, cancelled);
+    REQUIRE_FALSE(not_parsed.has_value());
+    CHECK(not_parsed.error() == myhtmlpp::cancelled_status);
+
+    myhtmlpp::ParseOptions reused;
+    reused.reuse_engine = true;
+    for (size_t i = 0; i < 3; ++i) {
+        auto first = myhtmlpp::parse(html, reused);
+        auto second = myhtmlpp::parse(html, reused);
+        CHECK(first.find_by_tag(myhtmlpp::TAG::LI).size() == 3);
+        CHECK(second.find_by_tag(myhtmlpp::TAG::LI).size() == 3);
+        first = myhtmlpp::parse("<ul><li>x</li></ul>", reused);
+        CHECK(first.find_by_tag(myhtmlpp::TAG::LI).size() == 1);
+    }
+
+    auto pending = myhtmlpp::parse_async(html);
+    auto async_tree = pending.get();
+    CHECK(async_tree.find_by_tag(myhtmlpp::TAG::LI).size() == 3);
+    CHECK(async_tree.source() == html);
+
+    myhtmlpp::Executor on_thread = [](std::function<void()> job) {
+        std::thread(std::move(job)).detach();
+    };
+    auto threaded = myhtmlpp::parse_async(html, {}, on_thread).get();
+    CHECK(threaded.find_by_tag(myhtmlpp::TAG::LI).size() == 3);
+
+    size_t jobs = 0;
+    myhtmlpp::Executor inline_executor = [&](std::function<void()> job) {
+        ++jobs;
+        job();
+    };
+    auto too_deep_async = myhtmlpp::parse_async(nested, limited,
+                                                inline_executor);
+    CHECK(jobs == 1);
+    CHECK_THROWS_AS(static_cast<void>(too_deep_async.get()),
+                    myhtmlpp::limit_exceeded);
 }
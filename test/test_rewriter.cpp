@@ -0,0 +1,101 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/rewriter.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+TEST_CASE("rewriter") {
+    std::string html(
+        "<html><head></head><body>\n"
+        "  <a   href=\"/x\" CLASS=link>x</a>\n"
+        "  <p>keep  <b>this</b></p><IMG src=a.png />\n"
+        "</body></html>");
+
+    auto tree = myhtmlpp::parse(html);
+    auto a_node = tree.find_by_tag(myhtmlpp::TAG::A).front();
+    auto p_node = tree.find_by_tag(myhtmlpp::TAG::P).front();
+    auto b_node = tree.find_by_tag(myhtmlpp::TAG::B).front();
+    auto img_node = tree.find_by_tag(myhtmlpp::TAG::IMG).front();
+
+    auto replaced = [&](std::string_view from, std::string_view to) {
+        std::string res = html;
+        res.replace(res.find(from), from.size(), to);
+        return res;
+    };
+
+    myhtmlpp::Rewriter rewriter(tree);
+
+    SUBCASE("no edits") {
+        CHECK(rewriter.size() == 0);
+        CHECK(rewriter.html() == html);
+    }
+
+    SUBCASE("attributes") {
+        rewriter.set_attribute(a_node, "href", "/y?a=1&b=\"2\"");
+        CHECK(rewriter.html() ==
+              replaced("<a   href=\"/x\" CLASS=link>",
+                       "<a href=\"/y?a=1&amp;b=&quot;2&quot;\" "
+                       "class=\"link\">"));
+
+        rewriter.remove_attribute(a_node, "class");
+        rewriter.set_attribute(a_node, "rel", "");
+        CHECK(rewriter.size() == 1);
+        CHECK(rewriter.html() ==
+              replaced("<a   href=\"/x\" CLASS=link>",
+                       "<a href=\"/y?a=1&amp;b=&quot;2&quot;\" rel=\"\">"));
+
+        myhtmlpp::Rewriter img_rewriter(tree);
+        img_rewriter.set_attribute(img_node, "alt", "");
+        CHECK(img_rewriter.html() == replaced("<IMG src=a.png />",
+                                              "<IMG src=\"a.png\" alt=\"\"/>"));
+    }
+
+    SUBCASE("nodes") {
+        rewriter.insert_after(img_node, "<br>");
+        rewriter.replace(b_node, "<i>that</i>");
+        rewriter.insert_before(a_node, "<nav>");
+        rewriter.insert_after(a_node, "</nav>");
+        CHECK(rewriter.html() ==
+              "<html><head></head><body>\n"
+              "  <nav><a   href=\"/x\" CLASS=link>x</a></nav>\n"
+              "  <p>keep  <i>that</i></p><IMG src=a.png /><br>\n"
+              "</body></html>");
+
+        myhtmlpp::Rewriter text_rewriter(tree);
+        text_rewriter.replace(*a_node.first_child(), "y");
+        CHECK(text_rewriter.html() == replaced(">x</a>", ">y</a>"));
+    }
+
+    SUBCASE("nested edits") {
+        rewriter.set_attribute(b_node, "id", "dropped");
+        rewriter.insert_after(b_node, "dropped");
+        rewriter.remove(p_node);
+        rewriter.insert_before(p_node, "<hr>");
+        CHECK(rewriter.html() ==
+              replaced("<p>keep  <b>this</b></p>", "<hr>"));
+    }
+
+    SUBCASE("implied elements") {
+        // the implied <html> starts after the empty implied <head>
+        std::string body_only_html("<p>x</p>");
+        auto body_only = myhtmlpp::parse(body_only_html);
+        myhtmlpp::Rewriter body_only_rewriter(body_only);
+        body_only_rewriter.replace(body_only.html_node(), "<p>y</p>");
+        CHECK(body_only_rewriter.html() == "<p>y</p>");
+    }
+
+    SUBCASE("errors") {
+        auto bad_node = *tree.end();
+        CHECK_THROWS_AS(rewriter.remove(bad_node), std::invalid_argument);
+        CHECK_THROWS_AS(rewriter.set_attribute(*b_node.first_child(), "a", ""),
+                        std::invalid_argument);
+        CHECK_THROWS_AS(
+            rewriter.set_attribute(tree.document_node(), "a", ""),
+            std::invalid_argument);
+    }
+}
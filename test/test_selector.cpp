@@ -0,0 +1,69 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <string>
+#include <utility>
+
+TEST_CASE("selector") {
+    SUBCASE("parse") {
+        myhtmlpp::Selector selector("div.item > a[href]");
+        CHECK(selector.text() == "div.item > a[href]");
+        CHECK(selector.streamable());
+
+        CHECK(myhtmlpp::Selector("ul li, #main").streamable());
+        CHECK(myhtmlpp::Selector("[lang|=en i]").streamable());
+        CHECK_FALSE(myhtmlpp::Selector("a:hover").streamable());
+        CHECK_FALSE(myhtmlpp::Selector("h1 + p").streamable());
+        CHECK_FALSE(myhtmlpp::Selector("h1 ~ p, p").streamable());
+
+        CHECK_THROWS_AS(myhtmlpp::Selector("div >"),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::Selector("[href"),
+                        myhtmlpp::selector_error);
+
+        auto parsed = myhtmlpp::Selector::try_create("ul li");
+        REQUIRE(parsed);
+        CHECK(parsed->text() == "ul li");
+        CHECK(parsed->streamable());
+
+        auto bad = myhtmlpp::Selector::try_create("[href");
+        REQUIRE_FALSE(bad.has_value());
+        CHECK(bad.error() == myhtmlpp::invalid_selector_status);
+    }
+
+    SUBCASE("move") {
+        myhtmlpp::Selector selector("p");
+        myhtmlpp::Selector moved(std::move(selector));
+        CHECK(moved.text() == "p");
+        CHECK(moved.streamable());
+    }
+
+    SUBCASE("select") {
+        auto tree = myhtmlpp::parse(
+            "<div class=\"item\"><a href=\"/x\">x</a><a>y</a></div>"
+            "<div><a href=\"/z\">z</a></div><p><a href=\"/w\">w</a></p>");
+
+        for (std::string text :
+             {"div.item > a[href]", "div a", "a[href^='/'], p", "a:hover"}) {
+            myhtmlpp::Selector selector(text);
+            auto expected = tree.select(text);
+            auto nodes = tree.select(selector);
+
+            REQUIRE(nodes.size() == expected.size());
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                CHECK(nodes[i] == expected[i]);
+            }
+
+            // the parsed selector is reused
+            CHECK(tree.select(selector).size() == nodes.size());
+        }
+
+        CHECK(tree.select(myhtmlpp::Selector("div.item > a[href]")).size() ==
+              1);
+        CHECK(tree.select(myhtmlpp::Selector("table")).empty());
+    }
+}
@@ -0,0 +1,145 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/serialization.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+TEST_CASE("serialization") {
+    auto tree = myhtmlpp::parse(
+        R"(<html><head><title>Foo</title></head><body>)"
+        R"(<p class="hello">Hello <b>World</b></p><!-- comment -->)"
+        R"(</body></html>)");
+
+    auto p_node = tree.find_by_tag(myhtmlpp::TAG::P).front();
+
+    SUBCASE("callback") {
+        std::string out;
+        size_t chunks = 0;
+        tree.write_html([&](std::string_view chunk) {
+            out.append(chunk);
+            ++chunks;
+        });
+        CHECK(out == tree.html());
+        CHECK(chunks > 1);
+
+        out.clear();
+        p_node.write_html([&](std::string_view chunk) { out.append(chunk); });
+        CHECK(out == R"(<p class="hello">)");
+        CHECK(out == p_node.html());
+
+        out.clear();
+        p_node.write_html_deep(
+            [&](std::string_view chunk) { out.append(chunk); });
+        CHECK(out == R"(<p class="hello">Hello <b>World</b></p>)");
+        CHECK(out == p_node.html_deep());
+    }
+
+    SUBCASE("ostream") {
+        std::stringstream sstream;
+        tree.write_html(myhtmlpp::ostream_sink(sstream));
+        CHECK(sstream.str() == tree.html());
+
+        std::stringstream node_sstream;
+        node_sstream << p_node;
+        CHECK(node_sstream.str() == p_node.html());
+    }
+
+    SUBCASE("file descriptor") {
+        std::FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+
+        p_node.write_html_deep(myhtmlpp::fd_sink(fileno(file)));
+
+        std::rewind(file);
+        std::string content(64, '\0');
+        content.resize(std::fread(content.data(), 1, content.size(), file));
+        std::fclose(file);
+        CHECK(content == p_node.html_deep());
+
+        CHECK_THROWS_AS(p_node.write_html(myhtmlpp::fd_sink(-1)),
+                        std::system_error);
+    }
+
+    SUBCASE("errors") {
+        size_t calls = 0;
+        auto failing_sink = [&](std::string_view) {
+            ++calls;
+            throw std::runtime_error("full");
+        };
+
+        CHECK_THROWS_AS(tree.write_html(failing_sink), std::runtime_error);
+        CHECK(calls == 1);
+
+        auto bad_node = *tree.end();
+        std::string out;
+        bad_node.write_html_deep(
+            [&](std::string_view chunk) { out.append(chunk); });
+        CHECK(out.empty());
+        CHECK(bad_node.html().empty());
+    }
+    SUBCASE("options") {
+        CHECK(tree.html(myhtmlpp::SerializeOptions{}) == tree.html());
+
+        myhtmlpp::SerializeOptions options;
+        options.skip_attributes = {"class"};
+        CHECK(p_node.html_deep(options) == "<p>Hello <b>World</b></p>");
+
+        options = {};
+        options.drop_comments = true;
+        CHECK(tree.html(options).find("comment") == std::string::npos);
+    }
+
+    SUBCASE("minify") {
+        auto minify = myhtmlpp::SerializeOptions::minify();
+
+        auto list_tree = myhtmlpp::parse(
+            "<ul>\n  <li class=\"a b\">one</li>\n  <li id=\"x\">two</li>\n"
+            "</ul>\n<pre>\n  keep  </pre><!-- c -->"
+            "<p data-x=\"\">a  &amp;\n b</p>");
+        auto body = list_tree.find_by_tag(myhtmlpp::TAG::BODY).front();
+        CHECK(body.html_deep(minify) ==
+              "<body><ul><li class=\"a b\">one<li id=x>two</ul>"
+              "<pre>  keep  </pre><p data-x>a &amp; b");
+
+        auto script_tree = myhtmlpp::parse(
+            "<div><script>if (a <  b) {}</script> <b>x</b>  y</div>");
+        auto div = script_tree.find_by_tag(myhtmlpp::TAG::DIV).front();
+
+        myhtmlpp::SerializeOptions options;
+        options.collapse_whitespace = true;
+        CHECK(div.html_deep(options) ==
+              "<div><script>if (a <  b) {}</script> <b>x</b> y</div>");
+
+        std::string out;
+        size_t chunks = 0;
+        list_tree.write_html(
+            [&](std::string_view chunk) {
+                out.append(chunk);
+                ++chunks;
+            },
+            minify);
+        CHECK(out == list_tree.html(minify));
+        CHECK(chunks == 1);
+
+        // `</x-card>` does not close the p, so its end tag is kept
+        std::string custom_html("<x-card><p>a</p></x-card><p>b</p>");
+        auto custom_tree = myhtmlpp::parse(custom_html);
+        auto custom_body = custom_tree.find_by_tag(myhtmlpp::TAG::BODY).front();
+        std::string minified = custom_body.html_deep(minify);
+        CHECK(minified == "<body><x-card><p>a</p></x-card><p>b");
+
+        auto reparsed = myhtmlpp::parse(minified);
+        CHECK(reparsed.find_by_tag(myhtmlpp::TAG::BODY).front().html_deep() ==
+              custom_body.html_deep());
+        CHECK(reparsed.select("x-card > p").size() == 1);
+    }
+}
@@ -0,0 +1,128 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/snapshot.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+TEST_CASE("snapshot") {
+    std::string html(
+        R"(<!DOCTYPE html>
+<html>
+<head>
+    <title>Foo</title>
+</head>
+<body>
+    <p class="hello">Hello <a href="/one">World</a></p>
+    <ul>
+        <li><a href="/two" id="second">two</a></li>
+        <li>three</li>
+    </ul>
+    <!-- comment -->
+</body>
+</html>)");
+
+    auto tree = myhtmlpp::parse(html);
+    auto snapshot = tree.snapshot();
+
+    SUBCASE("columns") {
+        CHECK(snapshot.size() ==
+              static_cast<size_t>(std::distance(tree.begin(), tree.end())));
+        CHECK(snapshot.tags().size() == snapshot.size());
+        CHECK(snapshot.parents().size() == snapshot.size());
+        CHECK(snapshot.subtree_ends().size() == snapshot.size());
+        CHECK(snapshot.depths().size() == snapshot.size());
+
+        auto root = snapshot.root();
+        CHECK(snapshot.node(root) == tree.document_node());
+        CHECK(!snapshot.parent(root).has_value());
+        CHECK(snapshot.depth(root) == 0);
+        CHECK(snapshot.subtree_end(root) == snapshot.size());
+    }
+
+    SUBCASE("pre-order") {
+        std::vector<myhtmlpp::Node> nodes(tree.begin(), tree.end());
+
+        for (uint32_t i = 0; i < snapshot.size(); ++i) {
+            myhtmlpp::NodeRef ref{i};
+
+            CHECK(snapshot.node(ref) == nodes[i]);
+            CHECK(snapshot.tag_id(ref) == nodes[i].tag_id());
+            if (nodes[i].tag_id() == myhtmlpp::TAG::TEXT_ ||
+                nodes[i].tag_id() == myhtmlpp::TAG::COMMENT_) {
+                CHECK(snapshot.text(ref) == nodes[i].text());
+            } else {
+                CHECK(snapshot.text(ref).empty());
+            }
+
+            if (auto parent = snapshot.parent(ref)) {
+                CHECK(snapshot.node(parent.value()) ==
+                      nodes[i].parent().value());
+                CHECK(snapshot.depth(ref) ==
+                      snapshot.depth(parent.value()) + 1);
+                CHECK(snapshot.subtree_end(ref) <=
+                      snapshot.subtree_end(parent.value()));
+            }
+        }
+    }
+
+    SUBCASE("attributes") {
+        auto links = snapshot.find_by_tag(myhtmlpp::TAG::A);
+        REQUIRE(links.size() == 2);
+
+        CHECK(snapshot.attribute_count(links[0]) == 1);
+        CHECK(snapshot.attribute_key(links[0], 0) == "href");
+        CHECK(snapshot.attribute_value(links[0], 0) == "/one");
+        CHECK(snapshot.attribute(links[1], "id") == "second");
+        CHECK(!snapshot.attribute(links[1], "class").has_value());
+    }
+
+    SUBCASE("scans") {
+        CHECK(snapshot.count(myhtmlpp::TAG::A) == 2);
+        CHECK(snapshot.count(myhtmlpp::TAG::LI) ==
+              tree.find_by_tag(myhtmlpp::TAG::LI).size());
+        CHECK(snapshot.count(myhtmlpp::TAG::TEXT_) ==
+              tree.find_by_tag(myhtmlpp::TAG::TEXT_).size());
+        CHECK(snapshot.count(myhtmlpp::TAG::TABLE) == 0);
+    }
+
+    SUBCASE("scoped") {
+        auto ul_node = tree.find_by_tag(myhtmlpp::TAG::UL).front();
+        auto ul_snapshot = tree.snapshot(ul_node);
+
+        CHECK(ul_snapshot.node(ul_snapshot.root()) == ul_node);
+        CHECK(ul_snapshot.count(myhtmlpp::TAG::LI) == 2);
+        CHECK(ul_snapshot.count(myhtmlpp::TAG::A) == 1);
+        CHECK(ul_snapshot.count(myhtmlpp::TAG::P) == 0);
+    }
+}
+
+TEST_CASE("snapshot overflow tags") {
+    // every distinct custom tag name gets a new tag id, enough of them push
+    // the last ids past the 16 bit tag column.
+    std::string html;
+    for (size_t i = 0; i < myhtmlpp::Snapshot::overflow_tag; ++i) {
+        std::string name = "x-" + std::to_string(i);
+        html += "<" + name + "></" + name + ">";
+    }
+
+    auto tree = myhtmlpp::parse(html);
+    auto snapshot = tree.snapshot();
+
+    auto last = tree.body_node().last_child();
+    REQUIRE(last.has_value());
+
+    auto tag = last.value().tag_id();
+    REQUIRE(static_cast<unsigned int>(tag) > myhtmlpp::Snapshot::overflow_tag);
+
+    auto found = snapshot.find_by_tag(tag);
+    REQUIRE(found.size() == 1);
+    CHECK(snapshot.node(found[0]) == last.value());
+    CHECK(snapshot.tag_id(found[0]) == tag);
+    CHECK(snapshot.count(tag) == 1);
+}
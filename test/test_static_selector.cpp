@@ -0,0 +1,98 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/static_selector.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+using namespace myhtmlpp::literals;
+
+namespace {
+
+constexpr auto links = "div.item > a[href]"_sel;
+static_assert(links.compiled());
+static_assert(links.alternatives() == 1);
+static_assert(links.compounds() == 2);
+static_assert(links.compound(0).tag_id == myhtmlpp::TAG::DIV);
+static_assert(links.compound(1).tag_id == myhtmlpp::TAG::A);
+static_assert(links.compound(1).child);
+
+static_assert(!"a:hover"_sel.compiled());
+static_assert(!"h1 + p"_sel.compiled());
+static_assert(!"DIV"_sel.compiled());
+static_assert("ul li, #main, [lang|=en i]"_sel.alternatives() == 3);
+
+// checks that `text` selects the same nodes as mycss
+void check_same(const myhtmlpp::Tree& tree, std::string_view text) {
+    myhtmlpp::StaticSelector selector(text);
+    auto nodes = tree.select(selector);
+    auto expected = tree.select(std::string(text));
+
+    CHECK(nodes.size() == expected.size());
+    for (const auto& node : nodes) {
+        CHECK(std::find(expected.begin(), expected.end(), node) !=
+              expected.end());
+    }
+}
+
+}  // namespace
+
+TEST_CASE("static_selector") {
+    auto tree = myhtmlpp::parse(
+        "<div class=\"item first\"><a href=\"/x\">x</a><a>y</a>"
+        "<span><a href=\"/deep\">deep</a></span></div>"
+        "<div lang=\"en-US\"><a href=\"/z\" title=\"Z\">z</a></div>"
+        "<p id=\"main\"><a href=\"https://example.com\">w</a></p>"
+        "<my-widget data-x=\"1\"><b>c</b></my-widget>");
+
+    SUBCASE("parse") {
+        CHECK(links.text() == "div.item > a[href]");
+
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector(""), myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector("div >"),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector("a,,b"),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector("[href"),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector("[href='x]"),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector("div."),
+                        myhtmlpp::selector_error);
+        CHECK_THROWS_AS(myhtmlpp::StaticSelector(".1a"),
+                        myhtmlpp::selector_error);
+    }
+
+    SUBCASE("select") {
+        CHECK(tree.select(links).size() == 1);
+        CHECK(tree.select("div a"_sel).size() == 4);
+        CHECK(tree.select("my-widget > b"_sel).size() == 1);
+        CHECK(tree.select("table"_sel).empty());
+
+        for (std::string_view text :
+             {"div.item > a[href]", "div a", "div > a", "*", "div *",
+              "[href^='/'], p", "#main a", ".first", "a[href$=\".com\"]",
+              "a[href*=deep]", "div[lang|=en] a[title=z i]", "my-widget",
+              "[data-x]", "span a, p > a", "a[title=z]"}) {
+            check_same(tree, text);
+        }
+    }
+
+    SUBCASE("fallback") {
+        check_same(tree, "a:first-child");
+        check_same(tree, "span ~ a, DIV");
+
+        auto hover = "a:hover"_sel;
+        CHECK(tree.select(hover).empty());
+        myhtmlpp::StaticSelector bad("a:");
+        CHECK_FALSE(bad.compiled());
+        CHECK_THROWS_AS(static_cast<void>(tree.select(bad)),
+                        myhtmlpp::selector_error);
+    }
+}
@@ -0,0 +1,138 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
+#include "myhtmlpp/selector.hpp"
+#include "myhtmlpp/stream_rewriter.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// rewrites `html` in chunks of `chunk_size` bytes with the handlers added
+// by `setup`.
+template <typename F>
+std::string rewrite(std::string_view html, size_t chunk_size, F&& setup) {
+    std::string res;
+    myhtmlpp::StreamRewriter rewriter(
+        [&](std::string_view data) { res.append(data); });
+    setup(rewriter);
+
+    for (size_t i = 0; i < html.size(); i += chunk_size) {
+        rewriter.write(html.substr(i, chunk_size));
+    }
+    rewriter.end();
+
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("stream_rewriter") {
+    std::string html(
+        "<!DOCTYPE html><html><head><script src=\"a.js\"></script>"
+        "<script>var x = \"<a href=1>\";</script></head><body>\n"
+        "<!-- <a href=2> -->\n"
+        "<ul><li><a   href=\"/x\" CLASS=link>x</a><li><a>y</a></ul>\n"
+        "<p>one<p>two<img src=a.png /></p>\n"
+        "</body></html>");
+
+    SUBCASE("no handlers") {
+        for (size_t chunk_size : {1, 3, 7, 64, 4096}) {
+            CHECK(rewrite(html, chunk_size, [](auto&) {}) == html);
+        }
+    }
+
+    SUBCASE("attributes") {
+        auto setup = [](myhtmlpp::StreamRewriter& rewriter) {
+            rewriter.on("li > a[href]", [](myhtmlpp::StreamElement& el) {
+                CHECK(el.tag_id() == myhtmlpp::TAG::A);
+                CHECK(el.attribute("href") == "/x");
+                el.set_attribute("href", "/y?a=1&b=2");
+                el.remove_attribute("class");
+            });
+        };
+
+        std::string expected = html;
+        std::string_view from("<a   href=\"/x\" CLASS=link>");
+        expected.replace(expected.find(from), from.size(),
+                         "<a href=\"/y?a=1&amp;b=2\">");
+
+        for (size_t chunk_size : {1, 5, 4096}) {
+            CHECK(rewrite(html, chunk_size, setup) == expected);
+        }
+    }
+
+    SUBCASE("remove") {
+        auto res = rewrite(html, 16, [](myhtmlpp::StreamRewriter& rewriter) {
+            rewriter.on("script[src]", [](myhtmlpp::StreamElement& el) {
+                el.remove();
+                el.after("<!-- removed -->");
+            });
+            rewriter.on("img", [](myhtmlpp::StreamElement& el) {
+                el.remove();
+                CHECK(el.removed());
+            });
+        });
+
+        CHECK(res.find("a.js") == std::string::npos);
+        CHECK(res.find("<head><!-- removed --><script>") != std::string::npos);
+        CHECK(res.find("<img") == std::string::npos);
+        CHECK(res.find("<p>two</p>") != std::string::npos);
+    }
+
+    SUBCASE("content") {
+        size_t calls = 0;
+        auto res = rewrite(html, 8, [&](myhtmlpp::StreamRewriter& rewriter) {
+            rewriter.on(myhtmlpp::Selector("li"),
+                        [&](myhtmlpp::StreamElement& el) {
+                            ++calls;
+                            el.prepend("[");
+                            el.append("]");
+                        });
+            rewriter.on("ul", [](myhtmlpp::StreamElement& el) {
+                el.before("<nav>");
+                el.after("</nav>");
+            });
+            rewriter.on("p", [](myhtmlpp::StreamElement& el) {
+                el.set_inner_html("<b>new</b>");
+            });
+        });
+
+        // the first <li> is closed by the second one, which has no end tag
+        CHECK(calls == 2);
+        CHECK(res.find("<nav><ul><li>[<a   href=\"/x\" CLASS=link>x</a>]"
+                       "<li>[<a>y</a>]</ul></nav>") != std::string::npos);
+        CHECK(res.find("<p><b>new</b><p><b>new</b></p>") !=
+              std::string::npos);
+    }
+
+    SUBCASE("errors") {
+        myhtmlpp::StreamRewriter rewriter([](std::string_view) {});
+        CHECK_THROWS_AS(rewriter.on("a:hover", [](auto&) {}),
+                        std::invalid_argument);
+        CHECK_THROWS_AS(rewriter.on("a[", [](auto&) {}),
+                        myhtmlpp::selector_error);
+
+        rewriter.on("a", [](myhtmlpp::StreamElement&) {
+            throw std::runtime_error("handler");
+        });
+        CHECK_THROWS_AS(rewriter.write("<p><a>x</a>"), std::runtime_error);
+
+        rewriter.end();
+        CHECK_THROWS_AS(rewriter.write("<p>"), std::logic_error);
+    }
+
+    SUBCASE("depth") {
+        myhtmlpp::StreamRewriter rewriter([](std::string_view) {});
+        rewriter.write("<div><ul><li>a<li>b");
+        rewriter.write("<br>");
+        CHECK(rewriter.depth() == 3);
+        rewriter.write("</ul>");
+        CHECK(rewriter.depth() == 1);
+        rewriter.end();
+        CHECK(rewriter.depth() == 0);
+    }
+}
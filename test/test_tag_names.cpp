@@ -0,0 +1,57 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/tag_names.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "utils.hpp"
+
+#include <cstddef>
+#include <myhtml/myhtml.h>
+#include <string>
+#include <string_view>
+
+static_assert(myhtmlpp::tag_from_name("div") == myhtmlpp::TAG::DIV);
+static_assert(myhtmlpp::tag_name(myhtmlpp::TAG::DIV) == "div");
+
+TEST_CASE("tag_names") {
+    SUBCASE("round trip") {
+        for (size_t i = 0; i < static_cast<size_t>(myhtmlpp::TAG::LAST_ENTRY);
+             ++i) {
+            auto tag_id = static_cast<myhtmlpp::TAG>(i);
+            CHECK(myhtmlpp::tag_from_name(myhtmlpp::tag_name(tag_id)) ==
+                  tag_id);
+        }
+    }
+
+    SUBCASE("names") {
+        CHECK(myhtmlpp::tag_name(myhtmlpp::TAG::A) == "a");
+        CHECK(myhtmlpp::tag_name(myhtmlpp::TAG::ANNOTATION_XML) ==
+              "annotation-xml");
+        CHECK(myhtmlpp::tag_name(myhtmlpp::TAG::TEXT_) == "-text");
+        CHECK(myhtmlpp::tag_name(myhtmlpp::TAG::LAST_ENTRY).empty());
+
+        CHECK(myhtmlpp::tag_from_name("font-face-uri") ==
+              myhtmlpp::TAG::FONT_FACE_URI);
+        CHECK(myhtmlpp::tag_from_name("!doctype") == myhtmlpp::TAG::DOCTYPE_);
+        CHECK(myhtmlpp::tag_from_name("DIV") == myhtmlpp::TAG::UNDEF_);
+        CHECK(myhtmlpp::tag_from_name("my-widget") == myhtmlpp::TAG::UNDEF_);
+        CHECK(myhtmlpp::tag_from_name("") == myhtmlpp::TAG::UNDEF_);
+    }
+
+    SUBCASE("same as myhtml") {
+        auto tree = myhtmlpp::parse("<p>x</p>");
+        myhtml_tree_t* raw_tree = myhtmlpp::RawAccess::tree(tree);
+
+        for (size_t i = 0; i < static_cast<size_t>(myhtmlpp::TAG::LAST_ENTRY);
+             ++i) {
+            auto tag_id = static_cast<myhtmlpp::TAG>(i);
+
+            size_t length = 0;
+            const char* name = myhtml_tag_name_by_id(
+                raw_tree, static_cast<myhtml_tag_id_t>(i), &length);
+            REQUIRE(name != nullptr);
+            CHECK(std::string_view(name, length) ==
+                  myhtmlpp::tag_name(tag_id));
+        }
+    }
+}
@@ -0,0 +1,307 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/text.hpp"
+#include "myhtmlpp/tree.hpp"
+#include "text_kernels.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("text") {
+    std::string html(
+        R"(<!DOCTYPE html>
+<html>
+<head>
+    <title>Title</title>
+    <style>p { color: red; }</style>
+    <script>var x = "<p>hidden</p>";</script>
+</head>
+<body>
+    <h1>  Heading   one </h1>
+    <p>Some   <b>bold</b>
+       text<br>next line</p>
+    <noscript>enable javascript</noscript>
+    <template><p>template</p></template>
+    <!-- comment -->
+    <ul><li>one</li><li>two</li></ul>
+    <pre>  keep
+   this</pre>
+    <table><tr><td>a</td><td>b</td></tr></table>
+</body>
+</html>)");
+
+    auto tree = myhtmlpp::parse(html);
+    auto body = tree.body_node();
+
+    SUBCASE("visible text") {
+        CHECK(body.visible_text() == "Heading one\n"
+                                     "Some bold text\n"
+                                     "next line\n"
+                                     "one\n"
+                                     "two\n"
+                                     "  keep\n"
+                                     "   this\n"
+                                     "a b");
+
+        CHECK(tree.head_node().visible_text() == "Title");
+        CHECK(tree.document_node().visible_text().rfind("Title\n", 0) == 0);
+    }
+
+    SUBCASE("inner text is unchanged") {
+        CHECK(tree.head_node().inner_text().find("color") !=
+              std::string::npos);
+    }
+
+    SUBCASE("options") {
+        myhtmlpp::VisibleTextOptions options;
+        options.skip_tags = {myhtmlpp::TAG::UL, myhtmlpp::TAG::PRE,
+                             myhtmlpp::TAG::TABLE};
+        options.block_newlines = false;
+
+        auto text = body.visible_text(options);
+        CHECK(text.find("enable javascript") != std::string::npos);
+        CHECK(text.find("one") == std::string::npos);
+        CHECK(text.find('\n') == std::string::npos);
+        CHECK(text.rfind("Heading one Some bold text next line", 0) == 0);
+
+        myhtmlpp::VisibleTextOptions raw;
+        raw.collapse_whitespace = false;
+        raw.block_newlines = false;
+        auto h1 = tree.find_by_tag(myhtmlpp::TAG::H1).front();
+        CHECK(h1.visible_text(raw) == "  Heading   one ");
+    }
+
+    SUBCASE("append") {
+        std::string buffer = "> ";
+        tree.head_node().visible_text_into(buffer);
+        CHECK(buffer == "> Title");
+
+        auto bad_node = *tree.end();
+        CHECK(bad_node.visible_text().empty());
+    }
+}
+
+TEST_CASE("normalize") {
+    SUBCASE("defaults") {
+        CHECK(myhtmlpp::normalize_text("").empty());
+        CHECK(myhtmlpp::normalize_text(" \t\n ").empty());
+        CHECK(myhtmlpp::normalize_text("  a \t b\r\n\fc  ") == "a b c");
+        CHECK(myhtmlpp::normalize_text("a\xC2\xA0\xC2\xA0" "b") == "a b");
+
+        // other characters starting with 0xC2 are kept
+        CHECK(myhtmlpp::normalize_text("\xC2\xA9 2019") == "\xC2\xA9 2019");
+    }
+
+    SUBCASE("long text") {
+        // longer than the SIMD blocks, with whitespace across block ends
+        std::string text;
+        std::string expected;
+        for (size_t i = 0; i < 100; ++i) {
+            text += "word" + std::string(i % 7 + 1, ' ') + "\xC2\xA0\n";
+            expected += i == 0 ? "word" : " word";
+        }
+
+        CHECK(myhtmlpp::normalize_text(text) == expected);
+    }
+
+    SUBCASE("options") {
+        myhtmlpp::NormalizeOptions keep;
+        keep.collapse_whitespace = false;
+        keep.trim = false;
+        keep.nbsp_to_space = false;
+        CHECK(myhtmlpp::normalize_text(" a\xC2\xA0 b ", keep) ==
+              " a\xC2\xA0 b ");
+
+        keep.nbsp_to_space = true;
+        CHECK(myhtmlpp::normalize_text(" a\xC2\xA0 b ", keep) == " a  b ");
+
+        keep.trim = true;
+        CHECK(myhtmlpp::normalize_text(" a\xC2\xA0 b ", keep) == "a  b");
+    }
+
+    SUBCASE("append") {
+        myhtmlpp::NormalizeOptions options;
+        options.trim = false;
+
+        std::string out;
+        myhtmlpp::append_normalized(out, "  one ", options);
+        myhtmlpp::append_normalized(out, "  two", options);
+        myhtmlpp::append_normalized(out, "three  ", options);
+        CHECK(out == "one twothree ");
+    }
+
+    SUBCASE("node text") {
+        auto tree = myhtmlpp::parse("<p>  a&nbsp;&nbsp;b\n  c </p>");
+        auto text_node = tree.find_by_tag(myhtmlpp::TAG::P)
+                             .front()
+                             .first_child()
+                             .value();
+
+        std::string out;
+        myhtmlpp::append_normalized(out, text_node.text_view());
+        CHECK(out == "a b c");
+    }
+}
+
+TEST_CASE("normalize kernels") {
+    std::vector<myhtmlpp::KERNEL> kernels;
+    for (auto kernel : {myhtmlpp::KERNEL::SSE2, myhtmlpp::KERNEL::AVX2}) {
+        if (myhtmlpp::kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+
+    // text of every length up to two AVX2 blocks and a bit, with runs of
+    // whitespace and no-break spaces across the 16 and 32 byte block ends
+    std::vector<std::string> inputs;
+    const char* pieces[] = {"a",  "bc",       " ",        "\t",   "\n",
+                            "  ", "\xC2\xA0", "\xC2\xA9", "\xC2"};
+    for (size_t length = 0; length <= 70; ++length) {
+        inputs.emplace_back(length, 'x');
+        inputs.emplace_back(length, ' ');
+
+        for (size_t start : {0, 13, 15, 16, 29, 31, 32, 47, 63, 64}) {
+            if (start >= length) {
+                break;
+            }
+
+            std::string spaces(length, 'x');
+            spaces.replace(start, 4, " \t\n ");
+            inputs.push_back(spaces.substr(0, length));
+
+            std::string nbsp(length, 'x');
+            nbsp.replace(start, 5, "\xC2\xA0 \xC2\xA0");
+            inputs.push_back(nbsp.substr(0, length));
+        }
+
+        unsigned int seed = static_cast<unsigned int>(length) + 1;
+        for (size_t round = 0; round < 4; ++round) {
+            std::string mixed;
+            while (mixed.size() < length) {
+                seed = seed * 1103515245U + 12345U;
+                mixed += pieces[(seed >> 16U) % 9];
+            }
+            mixed.resize(length);
+            inputs.push_back(mixed);
+        }
+    }
+
+    for (unsigned int flags = 0; flags < 8; ++flags) {
+        myhtmlpp::NormalizeOptions options;
+        options.collapse_whitespace = (flags & 1U) != 0;
+        options.trim = (flags & 2U) != 0;
+        options.nbsp_to_space = (flags & 4U) != 0;
+
+        for (const auto& input : inputs) {
+            for (const std::string prefix : {"", "x", "x "}) {
+                std::string expected = prefix;
+                myhtmlpp::append_normalized(expected, input, options,
+                                            myhtmlpp::KERNEL::SCALAR);
+
+                for (auto kernel : kernels) {
+                    INFO("kernel " << static_cast<unsigned int>(kernel)
+                                   << ", flags " << flags << ", input \""
+                                   << input << "\"");
+
+                    std::string out = prefix;
+                    myhtmlpp::append_normalized(out, input, options, kernel);
+                    CHECK(out == expected);
+                }
+            }
+        }
+    }
+
+    CHECK(myhtmlpp::kernel_supported(myhtmlpp::KERNEL::SCALAR));
+    CHECK(myhtmlpp::kernel_supported(myhtmlpp::best_kernel()));
+}
+
+TEST_CASE("find substring") {
+    std::string text;
+    for (size_t i = 0; i < 20; ++i) {
+        text += "lorem ipsum dolor sit amet ";
+    }
+    text += "needle";
+
+    CHECK(myhtmlpp::find_substring(text, "needle") == text.size() - 6);
+    CHECK(myhtmlpp::find_substring(text, "ipsum") == 6);
+    CHECK(myhtmlpp::find_substring(text, "ipsum", 7) == 33);
+    CHECK(myhtmlpp::find_substring(text, "d") == 12);
+    CHECK(myhtmlpp::find_substring(text, "") == 0);
+    CHECK(myhtmlpp::find_substring(text, "needles") == std::string::npos);
+    CHECK(myhtmlpp::find_substring(text, "lorem", text.size()) ==
+          std::string::npos);
+    CHECK(myhtmlpp::find_substring("", "a") == std::string::npos);
+
+    // every position of a block
+    for (size_t i = 0; i < 70; ++i) {
+        std::string haystack(100, 'a');
+        haystack.replace(i, 3, "abc");
+        CHECK(myhtmlpp::find_substring(haystack, "abc") == i);
+    }
+}
+
+TEST_CASE("find kernels") {
+    std::vector<myhtmlpp::KERNEL> kernels{myhtmlpp::KERNEL::SCALAR};
+    for (auto kernel : {myhtmlpp::KERNEL::SSE2, myhtmlpp::KERNEL::AVX2}) {
+        if (myhtmlpp::kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+
+    auto check_kernels = [&](const std::string& haystack,
+                             const std::string& needle, size_t pos) {
+        size_t expected = std::string_view(haystack).find(needle, pos);
+        for (auto kernel : kernels) {
+            INFO("kernel " << static_cast<unsigned int>(kernel) << ", needle \""
+                           << needle << "\", pos " << pos << ", haystack \""
+                           << haystack << "\"");
+            CHECK(myhtmlpp::find_substring(haystack, needle, pos, kernel) ==
+                  expected);
+        }
+    };
+
+    for (size_t length : {1, 2, 16, 17, 33}) {
+        std::string needle;
+        for (size_t i = 0; i < length; ++i) {
+            needle += static_cast<char>('a' + i % 26);
+        }
+
+        // candidates with the first and last byte of the needle that differ
+        // in between
+        std::string decoy = needle;
+        if (length > 2) {
+            decoy[length / 2] = '.';
+        }
+
+        for (size_t size : {length, size_t{40}, size_t{70}, size_t{100}}) {
+            for (bool decoys : {false, true}) {
+                std::string filler;
+                while (decoys && filler.size() < size) {
+                    filler += decoy + "-";
+                }
+                filler.resize(size, '-');
+
+                // matches at every offset, across the block ends and at the
+                // end of the haystack
+                for (size_t at = 0; at + length <= size; ++at) {
+                    std::string haystack = filler;
+                    haystack.replace(at, length, needle);
+
+                    for (size_t pos : {size_t{0}, at, at + 1}) {
+                        check_kernels(haystack, needle, pos);
+                    }
+                }
+
+                // a match cut off by the end of the haystack
+                std::string cut = filler.substr(0, size - length + 1) +
+                                  needle.substr(0, length - 1);
+                check_kernels(cut, needle, 0);
+                check_kernels(filler, needle, 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "doctest/doctest.h"
+#include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/node.hpp"
+#include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/text_arena.hpp"
+#include "myhtmlpp/tree.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+TEST_CASE("text arena") {
+    auto tree = myhtmlpp::parse(
+        R"(<html><head><title>Title</title></head><body>)"
+        R"(<p>Hello <b>Wor</b>ld</p><p>second</p><!-- hidden -->)"
+        R"(</body></html>)");
+
+    auto arena = tree.text_arena();
+
+    SUBCASE("text") {
+        CHECK(arena.text() == "TitleHello Worldsecond");
+        REQUIRE(arena.size() == 5);
+
+        CHECK(arena.text(0) == "Title");
+        CHECK(arena.text(1) == "Hello ");
+        CHECK(arena.text(2) == "Wor");
+        CHECK(arena.offset(2) == 11);
+        CHECK(arena.node(2).parent().value().tag_id() == myhtmlpp::TAG::B);
+
+        for (size_t i = 0; i < arena.size(); ++i) {
+            CHECK(arena.node(i).tag_id() == myhtmlpp::TAG::TEXT_);
+            CHECK(arena.node(i).text_view() == arena.text(i));
+        }
+    }
+
+    SUBCASE("offsets to nodes") {
+        CHECK(arena.index_at(0).value() == 0);
+        CHECK(arena.index_at(4).value() == 0);
+        CHECK(arena.index_at(5).value() == 1);
+        CHECK(arena.node_at(11).value() == arena.node(2));
+        CHECK(!arena.node_at(arena.text().size()).has_value());
+
+        // "World" spans two text nodes
+        size_t pos = arena.text().find("World");
+        REQUIRE(pos != std::string_view::npos);
+        auto nodes = arena.nodes_in(pos, pos + 5);
+        REQUIRE(nodes.size() == 2);
+        CHECK(nodes[0].text() == "Wor");
+        CHECK(nodes[1].text() == "ld");
+
+        CHECK(arena.nodes_in(pos, pos).empty());
+        CHECK(arena.nodes_in(0, 1000).size() == arena.size());
+    }
+
+    SUBCASE("scope") {
+        auto body_arena = tree.text_arena(tree.body_node());
+        CHECK(body_arena.text() == "Hello Worldsecond");
+        CHECK(body_arena.size() == 4);
+
+        auto second_p = tree.body_node().first_child().value().next().value();
+        CHECK(tree.text_arena(second_p).text() == "second");
+    }
+
+    SUBCASE("find elements") {
+        auto body_arena = tree.text_arena(tree.body_node());
+
+        for (std::string_view needle : {"o", "World", "o W", "second", "x"}) {
+            CHECK(arena.find_elements(needle) ==
+                  tree.find_text(needle, myhtmlpp::TEXT_SEARCH::ELEMENTS));
+            CHECK(body_arena.find_elements(needle) ==
+                  tree.find_text(needle, tree.body_node(),
+                                 myhtmlpp::TEXT_SEARCH::ELEMENTS));
+        }
+
+        CHECK(arena.root() == tree.document_node());
+        CHECK(arena.find_elements("").empty());
+        CHECK(arena.find_elements("World").front().tag_id() ==
+              myhtmlpp::TAG::P);
+    }
+}
@@ -1,14 +1,17 @@
 #include "doctest/doctest.h"
 #include "myhtmlpp/constants.hpp"
+#include "myhtmlpp/error.hpp"
 #include "myhtmlpp/filter.hpp"
 #include "myhtmlpp/node.hpp"
 #include "myhtmlpp/parser.hpp"
+#include "myhtmlpp/text.hpp"
 #include "myhtmlpp/tree.hpp"
 
 #include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -111,7 +114,16 @@ TEST_CASE("tree") {
         CHECK(tree.select("p.hello").size() == 1);
         CHECK(tree.select("ul > li").size() == 3);
         CHECK(tree.select("[class]").size() == 2);
-        CHECK(tree.select("isfb.s oai*/bnd7").empty());
+        CHECK_THROWS_AS(static_cast<void>(tree.select("isfb.s oai*/bnd7")),
+                        myhtmlpp::selector_error);
+
+        auto valid = tree.try_select("ul > li");
+        REQUIRE(valid.has_value());
+        CHECK(valid->size() == 3);
+
+        auto invalid = tree.try_select("div >");
+        REQUIRE_FALSE(invalid);
+        CHECK(invalid.error() == myhtmlpp::invalid_selector_status);
     }
 
     SUBCASE("find") {
@@ -129,6 +141,15 @@ TEST_CASE("tree") {
 
         CHECK(tree.find_by_tag("-text").size() == 21);
         CHECK(tree.find_by_tag(myhtmlpp::TAG::UNDEF_).size() == 1);
+        CHECK(tree.find_by_tag("-undef").size() == 1);
+        CHECK(tree.find_by_tag("P").empty());
+
+        auto custom = myhtmlpp::parse(
+            "<my-widget><p>a</p></my-widget><my-widget></my-widget>");
+        CHECK(custom.find_by_tag("my-widget").size() == 2);
+        CHECK(custom.find_by_tag("my-widget").front().tag_name() ==
+              "my-widget");
+        CHECK(custom.find_by_tag("p").size() == 1);
 
         CHECK(tree.find_by_class("hello").size() == 1);
         CHECK(tree.find_by_class("hello", tree.body_node()).size() == 1);
@@ -138,6 +159,45 @@ TEST_CASE("tree") {
         CHECK(tree.find_by_attr("src", "image.jpg", tree.head_node()).empty());
     }
 
+    SUBCASE("find text") {
+        auto text_nodes = tree.find_text("o");
+        REQUIRE(text_nodes.size() == 5);
+        CHECK(text_nodes[0].text() == "Foo");
+        CHECK(text_nodes[1].text() == "Hello World");
+        CHECK(text_nodes[2].text() == "boom");
+        CHECK(text_nodes[3].text() == "one");
+        CHECK(text_nodes[4].text() == "two");
+
+        CHECK(tree.find_text("o", tree.body_node()).size() == 4);
+        CHECK(tree.find_text("World").front().parent().value().tag_id() ==
+              myhtmlpp::TAG::P);
+        CHECK(tree.find_text("").empty());
+        CHECK(tree.find_text("not in the text").empty());
+
+        auto elements = tree.find_text("o", myhtmlpp::TEXT_SEARCH::ELEMENTS);
+        REQUIRE(elements.size() == 5);
+        CHECK(elements[0].tag_id() == myhtmlpp::TAG::TITLE);
+        CHECK(elements[1].tag_id() == myhtmlpp::TAG::P);
+        CHECK(elements[3].tag_id() == myhtmlpp::TAG::LI);
+
+        // matches across text nodes are found with ELEMENTS only
+        auto tree2 = myhtmlpp::parse("<p>fo<b>o</b> bar</p><p>foo</p>");
+        CHECK(tree2.find_text("foo").size() == 1);
+
+        auto spanning =
+            tree2.find_text("foo", myhtmlpp::TEXT_SEARCH::ELEMENTS);
+        REQUIRE(spanning.size() == 2);
+        CHECK(spanning[0].html_deep() == "<p>fo<b>o</b> bar</p>");
+        CHECK(spanning[1].html_deep() == "<p>foo</p>");
+
+        CHECK(tree2.find_text("o bar", myhtmlpp::TEXT_SEARCH::ELEMENTS)
+                  .front()
+                  .tag_id() == myhtmlpp::TAG::P);
+        CHECK(tree2.find_text("o", myhtmlpp::TEXT_SEARCH::ELEMENTS)
+                  .front()
+                  .tag_id() == myhtmlpp::TAG::P);
+    }
+
     SUBCASE("filter") {
         auto nodes_with_attrs =
             tree.filter([](const auto& node) { return node.has_attributes(); });
@@ -150,4 +210,46 @@ TEST_CASE("tree") {
         CHECK(nodes_with_attrs.begin() != nodes_with_attrs.end());
         CHECK((*nodes_with_attrs.begin()).tag_id() == myhtmlpp::TAG::DOCTYPE_);
     }
+
+    SUBCASE("parallel") {
+        auto has_attrs = [](const auto& node) { return node.has_attributes(); };
+
+        for (size_t threads : {0, 1, 2, 3, 8}) {
+            CHECK(tree.parallel_filter(has_attrs, threads) ==
+                  tree.filter(has_attrs).to_vector());
+            CHECK(tree.parallel_filter(has_attrs, tree.body_node(), threads)
+                      .size() == 3);
+
+            CHECK(tree.parallel_find_by_tag("p", threads) ==
+                  tree.find_by_tag("p"));
+            CHECK(tree.parallel_find_by_tag(myhtmlpp::TAG::TEXT_, threads) ==
+                  tree.find_by_tag(myhtmlpp::TAG::TEXT_));
+            CHECK(tree.parallel_find_by_class("hello", threads) ==
+                  tree.find_by_class("hello"));
+            CHECK(tree.parallel_find_by_id("bla", threads) ==
+                  tree.find_by_id("bla"));
+            CHECK(tree.parallel_find_by_attr("src", "image.jpg", threads) ==
+                  tree.find_by_attr("src", "image.jpg"));
+        }
+    }
+
+    SUBCASE("parallel throwing filter") {
+        auto throw_on_p = [](const auto& node) {
+            if (node.tag_id() == myhtmlpp::TAG::P) {
+                throw std::runtime_error("p");
+            }
+
+            return true;
+        };
+
+        for (size_t threads : {1, 2, 3, 8}) {
+            CHECK_THROWS_AS(
+                static_cast<void>(tree.parallel_filter(throw_on_p, threads)),
+                std::runtime_error);
+        }
+
+        auto has_attrs = [](const auto& node) { return node.has_attributes(); };
+        CHECK(tree.parallel_filter(has_attrs, 8) ==
+              tree.filter(has_attrs).to_vector());
+    }
 }